@@ -67,15 +67,22 @@ public:
 		return glm::lookAt(Position, Position + Front, Up);
 	}
 
-  std::vector<int> hitMaze(Maze& m)
+  // map is a Maze or ChunkWorld, anything with isWall(row, col)
+  template <class Map>
+  std::vector<int> hitMaze(Map& m)
   {
     int limit = 0.05;
     std::vector<int> test;
-    for (int row = 0; row < m.data.size(); row++)
+    // only the cells around the camera can be within reach, x is row and -z is col
+    int rowMin = (int)std::floor(this->Position.x) - 1;
+    int rowMax = (int)std::ceil(this->Position.x) + 1;
+    int colMin = (int)std::floor(-this->Position.z) - 1;
+    int colMax = (int)std::ceil(-this->Position.z) + 1;
+    for (int row = rowMin; row <= rowMax; row++)
       {
-	for (int col = 0; col < m.data[row].size(); col++)
+	for (int col = colMin; col <= colMax; col++)
 	  {
-	    if (!m.data[row][col] && this->Position.x > row - 0.5 - limit /*+x*/
+	    if (m.isWall(row, col) && this->Position.x > row - 0.5 - limit /*+x*/
 		&& this->Position.x < row + 0.5 + limit /*-x*/
 		&& this->Position.z < -1.0*col + 0.5 + limit /*-z,max*/
 		&& this->Position.z > -1.0*col - 0.5 - limit/*+z, min*/) // in vicinity of wall
@@ -109,7 +116,8 @@ public:
 
   
 	// Processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
-  void ProcessKeyboard(Camera_Movement direction, float deltaTime, Maze& m)
+  template <class Map>
+  void ProcessKeyboard(Camera_Movement direction, float deltaTime, Map& m)
 	{
 		float velocity = MovementSpeed * deltaTime;
 		std::vector<int> constrain = hitMaze(m);
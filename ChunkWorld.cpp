@@ -0,0 +1,104 @@
+#include "ChunkWorld.h"
+#include "Maze.h"
+#include <cmath>
+
+// opening on the border shared by two chunks, as a cell index along that border
+static int borderOpening(uint64_t seed, bool southBorder, int chunkRow, int chunkCol)
+{
+	uint64_t h = mixSeed(mixSeed(mixSeed(seed, southBorder ? 1 : 2), (uint32_t)chunkRow), (uint32_t)chunkCol);
+	return h % CHUNK_CELLS;
+}
+
+ChunkWorld::ChunkWorld(uint64_t seed, size_t capacity, unsigned threads) : seed(seed), capacity(capacity), changes(0), pool(threads)
+{
+}
+
+uint64_t ChunkWorld::key(int chunkRow, int chunkCol)
+{
+	return (uint64_t)(uint32_t)chunkRow << 32 | (uint32_t)chunkCol;
+}
+
+int ChunkWorld::chunkOf(int64_t gridPos)
+{
+	// floor division, so negative positions land in negative chunks
+	return (int)(gridPos >= 0 ? gridPos / CHUNK_SPAN : -((-gridPos + CHUNK_SPAN - 1) / CHUNK_SPAN));
+}
+
+MazeGrid ChunkWorld::generateChunk(uint64_t seed, int chunkRow, int chunkCol)
+{
+	Maze m(CHUNK_SPAN + 1, dfsIterative, mixSeed(mixSeed(seed, (uint32_t)chunkRow), (uint32_t)chunkCol));
+	// north and south borders belong to the border between chunk rows, west and east to columns
+	m.data.setOpen(0, 2 * borderOpening(seed, true, chunkRow - 1, chunkCol) + 1);
+	m.data.setOpen(CHUNK_SPAN, 2 * borderOpening(seed, true, chunkRow, chunkCol) + 1);
+	m.data.setOpen(2 * borderOpening(seed, false, chunkRow, chunkCol - 1) + 1, 0);
+	m.data.setOpen(2 * borderOpening(seed, false, chunkRow, chunkCol) + 1, CHUNK_SPAN);
+	return m.data;
+}
+
+void ChunkWorld::update(double row, double col, int radius)
+{
+	int centreRow = chunkOf((int64_t)std::floor(row));
+	int centreCol = chunkOf((int64_t)std::floor(col));
+	std::lock_guard<std::mutex> guard(lock);
+	for (int r = centreRow - radius; r <= centreRow + radius; r++)
+	{
+		for (int c = centreCol - radius; c <= centreCol + radius; c++)
+		{
+			uint64_t k = key(r, c);
+			auto found = chunks.find(k);
+			if (found != chunks.end())
+			{
+				recent.splice(recent.begin(), recent, found->second.used);
+			}
+			else if (pending.insert(k).second)
+			{
+				pool.submit([this, r, c, k]
+				{
+					auto grid = std::make_shared<const MazeGrid>(generateChunk(seed, r, c));
+					std::lock_guard<std::mutex> guard(lock);
+					pending.erase(k);
+					recent.push_front(k);
+					chunks[k] = Entry{grid, recent.begin()};
+					changes++;
+				});
+			}
+		}
+	}
+	// drop the least recently used chunks, never the ones around the player
+	for (auto it = recent.end(); chunks.size() > capacity && it != recent.begin();)
+	{
+		--it;
+		int r = (int)(*it >> 32), c = (int)(uint32_t)*it;
+		if (std::abs(r - centreRow) <= radius && std::abs(c - centreCol) <= radius)
+		{
+			continue;
+		}
+		chunks.erase(*it);
+		it = recent.erase(it);
+		changes++;
+	}
+}
+
+bool ChunkWorld::isWall(int64_t row, int64_t col)
+{
+	int chunkRow = chunkOf(row), chunkCol = chunkOf(col);
+	std::shared_ptr<const MazeGrid> grid = chunk(chunkRow, chunkCol);
+	if (!grid)
+	{
+		return true;
+	}
+	return grid->isWall(row - (int64_t)chunkRow * CHUNK_SPAN, col - (int64_t)chunkCol * CHUNK_SPAN);
+}
+
+std::shared_ptr<const MazeGrid> ChunkWorld::chunk(int chunkRow, int chunkCol)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	auto found = chunks.find(key(chunkRow, chunkCol));
+	return found == chunks.end() ? nullptr : found->second.grid;
+}
+
+unsigned ChunkWorld::version()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return changes;
+}
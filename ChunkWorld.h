@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include "MazeGrid.h"
+#include "ThreadPool.h"
+
+// cells per side of a chunk. a chunk is a grid of 2 * CHUNK_CELLS + 1 rows and columns whose
+// outer rows and columns are shared with its neighbours
+const int CHUNK_CELLS = 16;
+const int CHUNK_SPAN = 2 * CHUNK_CELLS;
+
+// endless maze made of chunks. every chunk is a perfect maze derived from a hash of
+// (world seed, chunk row, chunk col), with one opening on each border whose position
+// both neighbours derive from the same hash, so all chunks connect. chunks around the
+// player are generated on background threads and the least recently used ones are
+// dropped once more than capacity are held
+class ChunkWorld
+{
+private:
+	struct Entry
+	{
+		std::shared_ptr<const MazeGrid> grid;
+		std::list<uint64_t>::iterator used;
+	};
+	uint64_t seed;
+	size_t capacity;
+	std::mutex lock;
+	std::unordered_map<uint64_t, Entry> chunks;
+	std::list<uint64_t> recent; // most recently used first
+	std::set<uint64_t> pending;
+	unsigned changes;
+	ThreadPool pool; // last, so workers stop before the cache goes away
+
+	static uint64_t key(int chunkRow, int chunkCol);
+	static int chunkOf(int64_t gridPos);
+public:
+	ChunkWorld(uint64_t seed, size_t capacity, unsigned threads = 0);
+	uint64_t getSeed() const { return seed; }
+	// requests every chunk within radius chunks of world grid position (row, col) and
+	// evicts old chunks outside that radius past capacity
+	void update(double row, double col, int radius);
+	// world grid coordinates, cells of chunks that are not loaded yet count as walls
+	bool isWall(int64_t row, int64_t col);
+	// null while the chunk is not loaded
+	std::shared_ptr<const MazeGrid> chunk(int chunkRow, int chunkCol);
+	// bumped whenever a chunk is loaded or evicted
+	unsigned version();
+	static MazeGrid generateChunk(uint64_t seed, int chunkRow, int chunkCol);
+};
@@ -0,0 +1,350 @@
+#include "CorridorGraph.h"
+#include "Maze.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+CorridorGraph::CorridorGraph(const MazeGrid& grid) : nCellRows(cellsAlong(grid.rows())), nCellCols(cellsAlong(grid.cols())), query(0)
+{
+	size_t cells = (size_t)nCellRows * nCellCols;
+	cellRef.assign(cells, NONE);
+	cellOffset.assign(cells, 0);
+	// every cell that is not a corridor is a node, then corridors are walked from each node
+	for (uint32_t cell = 0; cell < cells; cell++)
+	{
+		int degree = 0;
+		for (int d = 0; d < 4; d++)
+		{
+			degree += openSide(grid, cell, d);
+		}
+		if (degree != 2)
+		{
+			addNode(cell);
+		}
+	}
+	for (uint32_t node = 0; node < nodeCells.size(); node++)
+	{
+		for (int d = 0; d < 4; d++)
+		{
+			if (openSide(grid, nodeCells[node], d))
+			{
+				walk(grid, node, d);
+			}
+		}
+	}
+	// what is left are loops of corridor without a junction, each gets one of its cells as node
+	for (uint32_t cell = 0; cell < cells; cell++)
+	{
+		if (cellRef[cell] == NONE)
+		{
+			uint32_t node = addNode(cell);
+			for (int d = 0; d < 4; d++)
+			{
+				if (openSide(grid, cell, d))
+				{
+					walk(grid, node, d);
+				}
+			}
+		}
+	}
+
+	adjacencyStart.assign(nodeCells.size() + 1, 0);
+	for (const Edge& e : edges)
+	{
+		adjacencyStart[e.a + 1]++;
+		if (e.b != e.a)
+		{
+			adjacencyStart[e.b + 1]++;
+		}
+	}
+	for (size_t n = 0; n < nodeCells.size(); n++)
+	{
+		adjacencyStart[n + 1] += adjacencyStart[n];
+	}
+	adjacency.resize(adjacencyStart.back());
+	std::vector<uint32_t> filled(adjacencyStart.begin(), adjacencyStart.end() - 1);
+	for (uint32_t id = 0; id < edges.size(); id++)
+	{
+		adjacency[filled[edges[id].a]++] = id;
+		if (edges[id].b != edges[id].a)
+		{
+			adjacency[filled[edges[id].b]++] = id;
+		}
+	}
+	states.resize(nodeCells.size());
+	for (size_t n = 0; n < nodeCells.size(); n++)
+	{
+		states[n] = SearchState{0, NONE, 0, (uint16_t)(nodeCells[n] / nCellCols), (uint16_t)(nodeCells[n] % nCellCols)};
+	}
+}
+
+bool CorridorGraph::openSide(const MazeGrid& grid, uint32_t cell, int d) const
+{
+	// passages out of the maze do not count
+	int r = cell / nCellCols + DIRECTION_ROWS[d];
+	int c = cell % nCellCols + DIRECTION_COLS[d];
+	return r >= 0 && c >= 0 && r < nCellRows && c < nCellCols && grid.isOpen(2 * r + 1 - DIRECTION_ROWS[d], 2 * c + 1 - DIRECTION_COLS[d]);
+}
+
+uint32_t CorridorGraph::addNode(uint32_t cell)
+{
+	uint32_t node = nodeCells.size();
+	nodeCells.push_back(cell);
+	cellRef[cell] = NODE_BIT | node;
+	return node;
+}
+
+void CorridorGraph::walk(const MazeGrid& grid, uint32_t node, int d)
+{
+	// follows the corridor leaving node towards d to the node at its other end, unless
+	// the edge was already found from that end
+	uint32_t cell = nodeCells[node];
+	auto step = [&](uint32_t from, int dir)
+	{
+		return (uint32_t)((int)from + DIRECTION_ROWS[dir] * nCellCols + DIRECTION_COLS[dir]);
+	};
+	uint32_t next = step(cell, d);
+	if (cellRef[next] != NONE)
+	{
+		// a node right next to this one, or a corridor already walked from its other end
+		if ((cellRef[next] & NODE_BIT) && (cellRef[next] & ~NODE_BIT) > node)
+		{
+			edges.push_back(Edge{node, cellRef[next] & ~NODE_BIT, 1});
+		}
+		return;
+	}
+	uint32_t id = edges.size();
+	uint32_t steps = 1;
+	int back = (d + 2) % 4;
+	while (cellRef[next] == NONE)
+	{
+		cellRef[next] = id;
+		cellOffset[next] = steps++;
+		int out = 0;
+		while (out == back || !openSide(grid, next, out))
+		{
+			out++;
+		}
+		next = step(next, out);
+		back = (out + 2) % 4;
+	}
+	edges.push_back(Edge{node, cellRef[next] & ~NODE_BIT, steps});
+}
+
+uint32_t CorridorGraph::cellIndex(int row, int col) const
+{
+	return (uint32_t)cellAt(row, nCellRows) * nCellCols + cellAt(col, nCellCols);
+}
+
+CorridorGraph::CellRef CorridorGraph::locate(int row, int col) const
+{
+	uint32_t cell = cellIndex(row, col);
+	if (cellRef[cell] & NODE_BIT)
+	{
+		return CellRef{true, cellRef[cell] & ~NODE_BIT, 0};
+	}
+	return CellRef{false, cellRef[cell], cellOffset[cell]};
+}
+
+uint32_t CorridorGraph::search(uint32_t from, uint32_t to, uint32_t& last) const
+{
+	// A* over the nodes. a corridor start is seeded at both ends of its edge, a corridor
+	// goal is reached from either end of its edge. last is the node the goal was reached
+	// from, NONE when the path stays on one edge
+	last = NONE;
+	if (from == to)
+	{
+		return 0;
+	}
+	query++;
+	uint32_t best = UNREACHED;
+	uint32_t fromRef = cellRef[from], toRef = cellRef[to];
+	if (!(fromRef & NODE_BIT) && fromRef == toRef)
+	{
+		best = (uint32_t)std::abs((int64_t)cellOffset[from] - cellOffset[to]);
+	}
+	int toRow = to / nCellCols, toCol = to % nCellCols;
+	auto estimate = [&](const SearchState& state)
+	{
+		return (uint32_t)(std::abs(state.row - toRow) + std::abs(state.col - toCol));
+	};
+	open.clear();
+	auto reach = [&](uint32_t node, uint32_t g, uint32_t edge)
+	{
+		SearchState& state = states[node];
+		if (state.stamp != query || g < state.cost)
+		{
+			state.stamp = query;
+			state.cost = g;
+			state.via = edge;
+			open.push_back((uint64_t)(g + estimate(state)) << 32 | node);
+			std::push_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		}
+	};
+	if (fromRef & NODE_BIT)
+	{
+		reach(fromRef & ~NODE_BIT, 0, SEED);
+	}
+	else
+	{
+		reach(edges[fromRef].a, cellOffset[from], SEED);
+		reach(edges[fromRef].b, edges[fromRef].length - cellOffset[from], SEED);
+	}
+	while (!open.empty())
+	{
+		uint64_t top = open.front();
+		std::pop_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		open.pop_back();
+		uint32_t node = (uint32_t)top;
+		uint32_t f = top >> 32;
+		if (f >= best)
+		{
+			break;
+		}
+		const SearchState& state = states[node];
+		if (state.cost + estimate(state) != f)
+		{
+			continue; // reached more cheaply since
+		}
+		uint32_t g = state.cost;
+		uint32_t done = UNREACHED;
+		if (toRef & NODE_BIT)
+		{
+			done = node == (toRef & ~NODE_BIT) ? g : UNREACHED;
+		}
+		else
+		{
+			const Edge& e = edges[toRef];
+			if (node == e.a)
+			{
+				done = g + cellOffset[to];
+			}
+			if (node == e.b)
+			{
+				done = std::min(done, g + e.length - cellOffset[to]);
+			}
+		}
+		if (done < best)
+		{
+			best = done;
+			last = node;
+		}
+		for (uint32_t i = adjacencyStart[node]; i < adjacencyStart[node + 1]; i++)
+		{
+			const Edge& e = edges[adjacency[i]];
+			if (e.a != e.b)
+			{
+				reach(e.a == node ? e.b : e.a, g + e.length, adjacency[i]);
+			}
+		}
+	}
+	return best;
+}
+
+std::vector<uint32_t> CorridorGraph::edgeCells(uint32_t edge) const
+{
+	// from node a to node b, each corridor cell found as the neighbour one further along
+	const Edge& e = edges[edge];
+	std::vector<uint32_t> cells(e.length + 1);
+	cells[0] = nodeCells[e.a];
+	for (uint32_t i = 1; i < e.length; i++)
+	{
+		int r = cells[i - 1] / nCellCols, c = cells[i - 1] % nCellCols;
+		for (int d = 0; d < 4; d++)
+		{
+			int nr = r + DIRECTION_ROWS[d], nc = c + DIRECTION_COLS[d];
+			uint32_t cell = (uint32_t)nr * nCellCols + nc;
+			if (nr >= 0 && nc >= 0 && nr < nCellRows && nc < nCellCols && cellRef[cell] == edge && cellOffset[cell] == i)
+			{
+				cells[i] = cell;
+				break;
+			}
+		}
+	}
+	cells[e.length] = nodeCells[e.b];
+	return cells;
+}
+
+uint32_t CorridorGraph::distance(int fromRow, int fromCol, int toRow, int toCol) const
+{
+	uint32_t last;
+	if (cellRef.empty())
+	{
+		return UNREACHED;
+	}
+	return search(cellIndex(fromRow, fromCol), cellIndex(toRow, toCol), last);
+}
+
+std::vector<std::pair<int, int>> CorridorGraph::path(int fromRow, int fromCol, int toRow, int toCol) const
+{
+	std::vector<std::pair<int, int>> steps;
+	if (cellRef.empty())
+	{
+		return steps;
+	}
+	uint32_t from = cellIndex(fromRow, fromCol), to = cellIndex(toRow, toCol);
+	uint32_t last;
+	if (search(from, to, last) == UNREACHED)
+	{
+		return steps;
+	}
+	std::vector<uint32_t> cells{from};
+	// cells of edge from offset first to offset end, either way round
+	auto append = [&](uint32_t edge, uint32_t first, uint32_t end)
+	{
+		std::vector<uint32_t> along = edgeCells(edge);
+		for (uint32_t i = first; i != end;)
+		{
+			i = end > first ? i + 1 : i - 1;
+			cells.push_back(along[i]);
+		}
+	};
+	uint32_t fromRef = cellRef[from], toRef = cellRef[to];
+	if (last == NONE)
+	{
+		if (from != to)
+		{
+			append(fromRef, cellOffset[from], cellOffset[to]);
+		}
+	}
+	else
+	{
+		// edges back from last to the node the search was seeded at
+		std::vector<uint32_t> hops;
+		uint32_t node = last;
+		while (states[node].via != SEED)
+		{
+			hops.push_back(states[node].via);
+			const Edge& e = edges[states[node].via];
+			node = e.a == node ? e.b : e.a;
+		}
+		if (!(fromRef & NODE_BIT))
+		{
+			const Edge& e = edges[fromRef];
+			bool towardsA = node == e.a && (e.a != e.b || cellOffset[from] <= e.length - cellOffset[from]);
+			append(fromRef, cellOffset[from], towardsA ? 0 : e.length);
+		}
+		for (size_t i = hops.size(); i-- > 0;)
+		{
+			const Edge& e = edges[hops[i]];
+			bool forward = nodeCells[e.a] == cells.back();
+			append(hops[i], forward ? 0 : e.length, forward ? e.length : 0);
+		}
+		if (!(toRef & NODE_BIT))
+		{
+			const Edge& e = edges[toRef];
+			bool fromA = last == e.a && (e.a != e.b || cellOffset[to] <= e.length - cellOffset[to]);
+			append(toRef, fromA ? 0 : e.length, cellOffset[to]);
+		}
+	}
+	for (size_t i = 0; i < cells.size(); i++)
+	{
+		int r = 2 * (cells[i] / nCellCols) + 1, c = 2 * (cells[i] % nCellCols) + 1;
+		if (i > 0)
+		{
+			steps.push_back({(r + steps.back().first) / 2, (c + steps.back().second) / 2});
+		}
+		steps.push_back({r, c});
+	}
+	return steps;
+}
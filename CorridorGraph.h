@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "MazeGrid.h"
+
+// a maze with its corridors collapsed: junctions and dead ends become nodes, and every run
+// of cells with exactly two open sides between them becomes one edge weighted by its length
+// in cell steps. each cell keeps a back reference to its node, or to its edge and how far
+// along it lies, so queries may start and end anywhere. shortest paths run A* on the nodes
+// with the manhattan distance as heuristic. mazes may be up to 65535 cells a side.
+class CorridorGraph
+{
+public:
+	struct Edge
+	{
+		uint32_t a;      // node at offset 0
+		uint32_t b;      // node at offset length
+		uint32_t length; // cell steps from a to b
+	};
+	// where a cell sits in the graph: a node, or offset steps along an edge from its a end
+	struct CellRef
+	{
+		bool node;
+		uint32_t id;
+		uint32_t offset;
+	};
+	static constexpr uint32_t UNREACHED = 0xffffffffu;
+private:
+	int nCellRows;
+	int nCellCols;
+	std::vector<uint32_t> nodeCells;
+	std::vector<Edge> edges;
+	std::vector<uint32_t> adjacencyStart; // edges of node n are adjacency[adjacencyStart[n]..adjacencyStart[n + 1])
+	std::vector<uint32_t> adjacency;
+	std::vector<uint32_t> cellRef;    // node id with NODE_BIT set, or edge id
+	std::vector<uint32_t> cellOffset; // along the edge, 0 for nodes
+	// A* scratch per node, valid when its stamp is the current query
+	struct SearchState
+	{
+		uint32_t cost;
+		uint32_t via; // edge that reached the node, or SEED
+		uint32_t stamp;
+		uint16_t row; // cell position, kept here for the heuristic
+		uint16_t col;
+	};
+	mutable std::vector<SearchState> states;
+	mutable std::vector<uint64_t> open; // estimated total << 32 | node, a min heap
+	mutable uint32_t query;
+
+	static constexpr uint32_t NODE_BIT = 0x80000000u;
+	static constexpr uint32_t NONE = 0xffffffffu;
+	static constexpr uint32_t SEED = 0xfffffffeu;
+
+	uint32_t cellIndex(int row, int col) const;
+	bool openSide(const MazeGrid& grid, uint32_t cell, int d) const;
+	uint32_t addNode(uint32_t cell);
+	void walk(const MazeGrid& grid, uint32_t node, int d);
+	uint32_t search(uint32_t from, uint32_t to, uint32_t& last) const;
+	std::vector<uint32_t> edgeCells(uint32_t edge) const;
+public:
+	CorridorGraph() : nCellRows(0), nCellCols(0), query(0) {}
+	explicit CorridorGraph(const MazeGrid& grid);
+
+	size_t nodeCount() const { return nodeCells.size(); }
+	size_t edgeCount() const { return edges.size(); }
+	const Edge& edge(uint32_t id) const { return edges[id]; }
+	// grid position of a node
+	std::pair<int, int> nodePosition(uint32_t node) const
+	{
+		return {2 * (int)(nodeCells[node] / nCellCols) + 1, 2 * (int)(nodeCells[node] % nCellCols) + 1};
+	}
+	CellRef locate(int row, int col) const;
+
+	// cell steps between the two positions, UNREACHED if they are not connected
+	uint32_t distance(int fromRow, int fromCol, int toRow, int toCol) const;
+	// grid positions from one to the other, passages included, empty if not connected
+	std::vector<std::pair<int, int>> path(int fromRow, int fromCol, int toRow, int toCol) const;
+};
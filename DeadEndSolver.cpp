@@ -0,0 +1,155 @@
+#include "DeadEndSolver.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+DeadEndSolver::DeadEndSolver(const MazeGrid& grid, int fromRow, int fromCol, int toRow, int toCol, unsigned threads) : corridor(grid),
+	dirtyStride((grid.wordsPerRow() + 63) / 64), rowDirty(grid.rows(), 1), ends{{fromRow, fromCol}, {toRow, toCol}}, sweeps(0)
+{
+	dirty.assign((size_t)dirtyStride * corridor.rows(), 0);
+	for (int row = 0; row < corridor.rows(); row++)
+	{
+		for (int word = 0; word < corridor.wordsPerRow(); word++)
+		{
+			markDirty(row, word);
+		}
+	}
+	ThreadPool pool(threads);
+	int bands = (corridor.rows() + DEAD_END_BAND_ROWS - 1) / DEAD_END_BAND_ROWS;
+	bool changed = true;
+	while (changed)
+	{
+		bool down = sweeps % 2 == 0;
+		std::atomic<bool> any(false);
+		for (int parity = 0; parity < 2; parity++)
+		{
+			pool.parallelFor((bands + 1 - parity) / 2, [&](size_t i)
+			{
+				if (fillBand(2 * i + parity, down))
+				{
+					any = true;
+				}
+			});
+		}
+		changed = any;
+		sweeps++;
+	}
+}
+
+void DeadEndSolver::markDirty(int row, int word)
+{
+	dirty[(size_t)row * dirtyStride + (word >> 6)] |= uint64_t(1) << (word & 63);
+	rowDirty[row] = 1;
+}
+
+uint64_t DeadEndSolver::fillWord(int row, int word)
+{
+	// an open position stays open if at least two of its four neighbours are open.
+	// neighbours outside the grid count as wall. returns the positions filled
+	int stride = corridor.wordsPerRow();
+	uint64_t* here = corridor.row(row);
+	uint64_t before = here[word];
+	uint64_t up = row > 0 ? corridor.row(row - 1)[word] : 0;
+	uint64_t down = row + 1 < corridor.rows() ? corridor.row(row + 1)[word] : 0;
+	uint64_t fromLeft = word > 0 ? here[word - 1] >> 63 : 0;
+	uint64_t fromRight = word + 1 < stride ? here[word + 1] << 63 : 0;
+	uint64_t keep = 0;
+	for (const int* end : ends)
+	{
+		if (end[0] == row && (end[1] >> 6) == word)
+		{
+			keep |= uint64_t(1) << (end[1] & 63);
+		}
+	}
+	uint64_t vertical = up & down, either = up | down;
+	uint64_t bits = before;
+	while (true)
+	{
+		// filling one position can expose the next one along the word, so repeat until stable
+		uint64_t left = bits << 1 | fromLeft;
+		uint64_t right = bits >> 1 | fromRight;
+		uint64_t next = bits & (vertical | (either & (left | right)) | (left & right) | keep);
+		if (next == bits)
+		{
+			break;
+		}
+		bits = next;
+	}
+	here[word] = bits;
+	return before & ~bits;
+}
+
+bool DeadEndSolver::fillRow(int row)
+{
+	// evaluates the dirty words of the row until none is left, dirtying the words next to
+	// any filled position that still has an open neighbour there
+	int stride = corridor.wordsPerRow();
+	uint64_t* marks = &dirty[(size_t)row * dirtyStride];
+	bool changed = false;
+	while (rowDirty[row])
+	{
+		rowDirty[row] = 0;
+		for (int k = 0; k < dirtyStride; k++)
+		{
+			while (marks[k])
+			{
+				int word = k * 64 + __builtin_ctzll(marks[k]);
+				marks[k] &= marks[k] - 1;
+				uint64_t filled = fillWord(row, word);
+				if (!filled)
+				{
+					continue;
+				}
+				changed = true;
+				const uint64_t* here = corridor.row(row);
+				if ((filled & 1) && word > 0 && (here[word - 1] >> 63))
+				{
+					markDirty(row, word - 1);
+				}
+				if ((filled >> 63) && word + 1 < stride && (here[word + 1] & 1))
+				{
+					markDirty(row, word + 1);
+				}
+				if (row > 0 && (filled & corridor.row(row - 1)[word]))
+				{
+					markDirty(row - 1, word);
+				}
+				if (row + 1 < corridor.rows() && (filled & corridor.row(row + 1)[word]))
+				{
+					markDirty(row + 1, word);
+				}
+			}
+		}
+	}
+	return changed;
+}
+
+bool DeadEndSolver::fillBand(int band, bool down)
+{
+	// walks the band in the sweep direction, stepping back whenever the row behind got
+	// dirty, so the band is settled when the walk leaves it. rows just outside the band
+	// may get dirty, they belong to bands not running now
+	int first = band * DEAD_END_BAND_ROWS, last = std::min(first + DEAD_END_BAND_ROWS, corridor.rows()) - 1;
+	int step = down ? 1 : -1;
+	bool changed = false;
+	for (int row = down ? first : last; row >= first && row <= last;)
+	{
+		if (rowDirty[row] && fillRow(row))
+		{
+			changed = true;
+		}
+		int behind = row - step;
+		row = behind >= first && behind <= last && rowDirty[behind] ? behind : row + step;
+	}
+	return changed;
+}
+
+uint64_t DeadEndSolver::openCount() const
+{
+	uint64_t count = 0;
+	for (size_t i = 0; i < corridor.wordCount(); i++)
+	{
+		count += __builtin_popcountll(corridor.words()[i]);
+	}
+	return count;
+}
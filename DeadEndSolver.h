@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "MazeGrid.h"
+
+// rows per band of the dead end filler. bands are swept alternately, even bands together
+// and then odd ones, so threads never write rows next to each other
+const int DEAD_END_BAND_ROWS = 64;
+
+// second solver next to MazeSolver: dead end filling run as a cellular automaton on a copy
+// of the grid. an open position with at most one open neighbour becomes wall, unless it is
+// one of the two ends, until nothing changes. every word of a row is evaluated 64 positions
+// at a time with shifts and a two-of-four majority, in place and only where a neighbour
+// was filled. a sweep settles each band completely, stepping back up whenever a row above got
+// dirty, so only dead ends reaching across bands need further sweeps. what stays open is the
+// corridor joining the two ends; in a perfect maze that is exactly the solution path. no
+// queue or per cell state is kept besides one dirty bit per word.
+class DeadEndSolver
+{
+private:
+	MazeGrid corridor;
+	// one bit per word of the grid, set when a neighbour it touches was filled since the
+	// word was last evaluated, and per row whether any of them is set
+	std::vector<uint64_t> dirty;
+	int dirtyStride;
+	std::vector<uint8_t> rowDirty;
+	int ends[2][2];
+	int sweeps;
+
+	uint64_t fillWord(int row, int word);
+	void markDirty(int row, int word);
+	bool fillRow(int row);
+	bool fillBand(int band, bool down);
+public:
+	DeadEndSolver(const MazeGrid& grid, int fromRow, int fromCol, int toRow, int toCol, unsigned threads = 0);
+
+	// the grid with every dead end walled up
+	const MazeGrid& solution() const { return corridor; }
+	bool onPath(int row, int col) const { return corridor.isOpen(row, col); }
+	// open grid positions left, passages included. on a perfect maze whose ends are
+	// connected, the path is (openCount() - 1) / 2 cell steps long
+	uint64_t openCount() const;
+	// passes over the grid until nothing changed, the last one included
+	int sweepCount() const { return sweeps; }
+};
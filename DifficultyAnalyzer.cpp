@@ -0,0 +1,119 @@
+#include "DifficultyAnalyzer.h"
+#include "CorridorGraph.h"
+#include "MazeSolver.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+// cell rows counted per task
+const int DIFFICULTY_BAND_ROWS = 128;
+
+// cells sit at odd columns, so at the odd bits of every word
+const uint64_t CELL_BITS = 0xaaaaaaaaaaaaaaaaull;
+
+void countCells(const MazeGrid& grid, Difficulty& result, unsigned threads)
+{
+	int cellRows = cellsAlong(grid.rows()), stride = grid.wordsPerRow();
+	int bands = (cellRows + DIFFICULTY_BAND_ROWS - 1) / DIFFICULTY_BAND_ROWS;
+	// per band cells, dead ends, junctions and branches, added up in order afterwards
+	std::vector<uint64_t> counts((size_t)bands * 4, 0);
+	ThreadPool pool(threads);
+	pool.parallelFor(bands, [&](size_t band)
+	{
+		uint64_t* count = &counts[band * 4];
+		int last = std::min((int)(band + 1) * DIFFICULTY_BAND_ROWS, cellRows);
+		for (int r = band * DIFFICULTY_BAND_ROWS; r < last; r++)
+		{
+			const uint64_t* above = grid.row(2 * r);
+			const uint64_t* here = grid.row(2 * r + 1);
+			const uint64_t* below = grid.row(2 * r + 2);
+			for (int w = 0; w < stride; w++)
+			{
+				// the open sides of every cell of the word, one bit plane per direction
+				uint64_t cells = here[w] & CELL_BITS;
+				uint64_t north = above[w], south = below[w];
+				uint64_t east = here[w] >> 1 | (w + 1 < stride ? here[w + 1] << 63 : 0);
+				uint64_t west = here[w] << 1 | (w > 0 ? here[w - 1] >> 63 : 0);
+				uint64_t odd = north ^ south ^ east ^ west;
+				uint64_t two = (north & south) | ((north | south) & (east | west)) | (east & west);
+				uint64_t four = north & south & east & west;
+				count[0] += __builtin_popcountll(cells);
+				count[1] += __builtin_popcountll(cells & odd & ~two);
+				count[2] += __builtin_popcountll(cells & ((odd & two) | four));
+				count[3] += 2 * __builtin_popcountll(cells & odd & two) + 3 * __builtin_popcountll(cells & four);
+			}
+		}
+	});
+	result.cells = result.deadEnds = result.junctions = result.branches = 0;
+	for (int band = 0; band < bands; band++)
+	{
+		result.cells += counts[band * 4];
+		result.deadEnds += counts[band * 4 + 1];
+		result.junctions += counts[band * 4 + 2];
+		result.branches += counts[band * 4 + 3];
+	}
+}
+
+bool analyze(const MazeGrid& grid, Difficulty& result, unsigned threads, const DifficultyRange* range)
+{
+	result = Difficulty{};
+	countCells(grid, result, threads);
+	if (range && (result.deadEnds < range->minDeadEnds || result.deadEnds > range->maxDeadEnds))
+	{
+		return false;
+	}
+	MazeSolver fromGoal(grid, grid.rows() - 2, grid.cols() - 2, threads);
+	result.solution = fromGoal.distance(1, 1);
+	if (range && (result.solution < range->minSolution || result.solution > range->maxSolution))
+	{
+		return false;
+	}
+	// in a tree the cell farthest from any cell is one end of a longest path
+	std::pair<int, int> end = fromGoal.farthest();
+	result.diameter = MazeSolver(grid, end.first, end.second, threads).maxDistance();
+	CorridorGraph graph(grid);
+	for (uint32_t i = 0; i < graph.edgeCount(); i++)
+	{
+		uint32_t length = graph.edge(i).length;
+		result.corridors[std::min(31 - __builtin_clz(length), CORRIDOR_BUCKETS - 1)]++;
+	}
+	return true;
+}
+
+std::vector<Difficulty> analyzeBatch(const std::vector<const MazeGrid*>& grids, unsigned threads)
+{
+	std::vector<Difficulty> results(grids.size());
+	ThreadPool pool(threads);
+	pool.parallelFor(grids.size(), [&](size_t i)
+	{
+		analyze(*grids[i], results[i], 1);
+	});
+	return results;
+}
+
+bool generateInRange(int size, generator gen, uint64_t firstSeed, const DifficultyRange& range, int tries, Maze& found,
+	Difficulty& result, unsigned threads)
+{
+	ThreadPool pool(threads);
+	for (int tried = 0; tried < tries; tried += pool.size())
+	{
+		int wave = std::min<int>(pool.size(), tries - tried);
+		std::vector<Maze> candidates(wave);
+		std::vector<Difficulty> difficulties(wave);
+		std::vector<char> accepted(wave, 0);
+		pool.parallelFor(wave, [&](size_t i)
+		{
+			candidates[i] = Maze(size, gen, firstSeed + tried + i, 1);
+			accepted[i] = analyze(candidates[i].data, difficulties[i], 1, &range);
+		});
+		for (int i = 0; i < wave; i++)
+		{
+			if (accepted[i])
+			{
+				found = candidates[i];
+				result = difficulties[i];
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Maze.h"
+#include "MazeGrid.h"
+
+// corridor lengths are counted in buckets of powers of two
+const int CORRIDOR_BUCKETS = 24;
+
+// what makes a maze hard to solve. corridors are the runs of cells with two open sides
+// between junctions and dead ends, as the edges of CorridorGraph. the solution runs from
+// the top left cell to the bottom right one, as in the game
+struct Difficulty
+{
+	uint64_t cells;
+	uint64_t deadEnds;  // cells with one open side
+	uint64_t junctions; // cells with three or four
+	uint64_t branches;  // ways on out of all junctions, not counting the way in
+	uint32_t solution;  // cell steps, MazeSolver::UNREACHED if the corners are not connected
+	uint32_t diameter;  // longest shortest path in cell steps, exact on perfect mazes and a lower bound otherwise
+	uint64_t corridors[CORRIDOR_BUCKETS]; // corridors of 2^i to 2^(i + 1) - 1 cell steps
+	double branchingFactor() const { return junctions > 0 ? (double)branches / junctions : 0; }
+};
+
+// bounds a maze has to fall in, inclusive. they are checked cheapest first, so most
+// candidates are turned down before the diameter and corridors are worked out
+struct DifficultyRange
+{
+	uint64_t minDeadEnds = 0;
+	uint64_t maxDeadEnds = UINT64_MAX;
+	uint32_t minSolution = 0;
+	uint32_t maxSolution = UINT32_MAX - 1;
+};
+
+// counts cells, dead ends and junctions in one pass a word at a time, bands of rows
+// spread over the pool
+void countCells(const MazeGrid& grid, Difficulty& result, unsigned threads = 0);
+// the whole analysis: counts, then a BFS from the goal for the solution and a second one
+// from the cell farthest from it for the diameter, then the corridors. with a range it
+// returns false as soon as a bound fails, the fields not reached yet are left zero
+bool analyze(const MazeGrid& grid, Difficulty& result, unsigned threads = 0, const DifficultyRange* range = nullptr);
+// one analysis per grid across the pool, each on a single thread
+std::vector<Difficulty> analyzeBatch(const std::vector<const MazeGrid*>& grids, unsigned threads = 0);
+// generates mazes with seeds firstSeed, firstSeed + 1, ... a pool's worth at a time until
+// one falls in range, trying at most tries seeds. the lowest accepted seed wins, so the
+// result is the same whatever the number of threads. false if none was accepted
+bool generateInRange(int size, generator gen, uint64_t firstSeed, const DifficultyRange& range, int tries, Maze& found,
+	Difficulty& result, unsigned threads = 0);
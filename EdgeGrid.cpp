@@ -0,0 +1,44 @@
+#include "EdgeGrid.h"
+
+EdgeGrid::EdgeGrid(const MazeGrid& grid) : EdgeGrid(cellsAlong(grid.rows()), cellsAlong(grid.cols()))
+{
+	for (int r = 0; r < nCellRows; r++)
+	{
+		int row = 2 * r + 1;
+		for (int c = 0; c < nCellCols; c++)
+		{
+			int col = 2 * c + 1;
+			if (grid.isOpen(row, col + 1))
+			{
+				east.setOpen(r, c);
+			}
+			if (grid.isOpen(row + 1, col))
+			{
+				south.setOpen(r, c);
+			}
+		}
+	}
+}
+
+MazeGrid EdgeGrid::toGrid() const
+{
+	MazeGrid grid(rows(), cols());
+	for (int r = 0; r < nCellRows; r++)
+	{
+		int row = 2 * r + 1;
+		for (int c = 0; c < nCellCols; c++)
+		{
+			int col = 2 * c + 1;
+			grid.setOpen(row, col);
+			if (east.isOpen(r, c))
+			{
+				grid.setOpen(row, col + 1);
+			}
+			if (south.isOpen(r, c))
+			{
+				grid.setOpen(row + 1, col);
+			}
+		}
+	}
+	return grid;
+}
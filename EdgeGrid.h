@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include "MazeGrid.h"
+
+// compact maze layout: one entry per cell instead of the (2N+1) grid of cells, walls and
+// posts. every cell keeps two bits, whether the passage to its east and to its south is
+// open, in two MazeGrid bit planes (set bit open, as in MazeGrid). the west and north edge
+// of the maze are always wall, posts are always wall and cells always open, which holds for
+// every generator in Maze.h. isWall answers in grid coordinates, so the mesher and Camera
+// collision use an EdgeGrid the same way as a MazeGrid
+class EdgeGrid
+{
+private:
+	int nCellRows;
+	int nCellCols;
+	MazeGrid east;
+	MazeGrid south;
+public:
+	EdgeGrid() : nCellRows(0), nCellCols(0) {}
+	// all walls
+	EdgeGrid(int cellRows, int cellCols) : nCellRows(cellRows), nCellCols(cellCols), east(cellRows, cellCols), south(cellRows, cellCols) {}
+	// from a (2N+1) grid, only the passages between cells are read
+	explicit EdgeGrid(const MazeGrid& grid);
+	// back to the (2N+1) layout
+	MazeGrid toGrid() const;
+
+	int cellRows() const { return nCellRows; }
+	int cellCols() const { return nCellCols; }
+	size_t byteCount() const { return (east.wordCount() + south.wordCount()) * sizeof(uint64_t); }
+
+	bool eastOpen(int cellRow, int cellCol) const { return east.isOpen(cellRow, cellCol); }
+	bool southOpen(int cellRow, int cellCol) const { return south.isOpen(cellRow, cellCol); }
+	void openEast(int cellRow, int cellCol) { east.setOpen(cellRow, cellCol); }
+	void openSouth(int cellRow, int cellCol) { south.setOpen(cellRow, cellCol); }
+
+	// same read interface as MazeGrid, in grid coordinates
+	int rows() const { return 2 * nCellRows + 1; }
+	int cols() const { return 2 * nCellCols + 1; }
+	bool isWall(int row, int col) const
+	{
+		if (row & col & 1)
+		{
+			return false; // cell
+		}
+		if (!((row | col) & 1))
+		{
+			return true; // post
+		}
+		if (row & 1)
+		{
+			// between the cells to the west and east, col 0 is the west edge
+			return col == 0 || east.isWall(row >> 1, (col >> 1) - 1);
+		}
+		return row == 0 || south.isWall((row >> 1) - 1, col >> 1);
+	}
+	bool isOpen(int row, int col) const
+	{
+		return !isWall(row, col);
+	}
+};
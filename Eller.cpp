@@ -0,0 +1,132 @@
+#include "Eller.h"
+#include <algorithm>
+
+// label of a cell that has no set yet
+const uint32_t NO_SET = UINT32_MAX;
+
+EllerGenerator::EllerGenerator(int width, uint64_t seed) : width(width), rng(seed), randomBits(0), bitsLeft(0)
+{
+	label.assign(width, NO_SET);
+	parent.resize(width);
+	remaining.resize(width);
+	goesDown.resize(width);
+	freeLabels.reserve(width);
+	cellRow.resize(wordsPerRow());
+	wallRow.resize(wordsPerRow());
+}
+
+bool EllerGenerator::coin()
+{
+	if (bitsLeft == 0)
+	{
+		randomBits = rng.next();
+		bitsLeft = 64;
+	}
+	bitsLeft--;
+	bool bit = randomBits & 1;
+	randomBits >>= 1;
+	return bit;
+}
+
+uint32_t EllerGenerator::find(uint32_t l)
+{
+	while (parent[l] != l)
+	{
+		parent[l] = parent[parent[l]];
+		l = parent[l];
+	}
+	return l;
+}
+
+static void setBit(std::vector<uint64_t>& words, int col)
+{
+	words[col >> 6] |= uint64_t(1) << (col & 63);
+}
+
+void EllerGenerator::generate(int rows, const RowConsumer& consumer)
+{
+	label.assign(width, NO_SET);
+	freeLabels.clear();
+	for (int l = width - 1; l >= 0; l--)
+	{
+		freeLabels.push_back(l);
+	}
+	std::fill(wallRow.begin(), wallRow.end(), 0);
+	consumer(0, wallRow.data()); // outer wall
+	if (rows <= 0)
+	{
+		return; // no cells, the one wall row is the whole grid
+	}
+	for (int r = 0; r < rows; r++)
+	{
+		bool lastRow = r == rows - 1;
+		std::fill(cellRow.begin(), cellRow.end(), 0);
+		std::fill(wallRow.begin(), wallRow.end(), 0);
+		for (int l = 0; l < width; l++)
+		{
+			parent[l] = l;
+		}
+		// cells not carried down from the row above start in a set of their own
+		for (int c = 0; c < width; c++)
+		{
+			if (label[c] == NO_SET)
+			{
+				label[c] = freeLabels.back();
+				freeLabels.pop_back();
+			}
+			setBit(cellRow, 2 * c + 1);
+		}
+		// randomly join neighbours in different sets, the last row joins them all
+		for (int c = 0; c + 1 < width; c++)
+		{
+			uint32_t a = find(label[c]);
+			uint32_t b = find(label[c + 1]);
+			if (a != b && (lastRow || coin()))
+			{
+				parent[b] = a;
+				setBit(cellRow, 2 * c + 2);
+			}
+		}
+		for (int c = 0; c < width; c++)
+		{
+			label[c] = find(label[c]);
+		}
+		consumer(2 * r + 1, cellRow.data());
+		if (lastRow)
+		{
+			break;
+		}
+		// every set carries at least one cell down, the rest go down at random
+		std::fill(remaining.begin(), remaining.end(), 0);
+		std::fill(goesDown.begin(), goesDown.end(), 0);
+		for (int c = 0; c < width; c++)
+		{
+			remaining[label[c]]++;
+		}
+		for (int c = 0; c < width; c++)
+		{
+			uint32_t l = label[c];
+			remaining[l]--;
+			if (coin() || (!goesDown[l] && remaining[l] == 0))
+			{
+				goesDown[l] = 1;
+				setBit(wallRow, 2 * c + 1);
+			}
+			else
+			{
+				label[c] = NO_SET;
+			}
+		}
+		freeLabels.clear();
+		for (int l = width - 1; l >= 0; l--)
+		{
+			if (!goesDown[l])
+			{
+				freeLabels.push_back(l);
+			}
+		}
+		consumer(2 * r + 2, wallRow.data());
+	}
+	std::fill(wallRow.begin(), wallRow.end(), 0);
+	consumer(2 * rows, wallRow.data()); // outer wall
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Rng.h"
+
+// receives one grid row of a maze, laid out like a MazeGrid row (set bit = open)
+typedef std::function<void(int row, const uint64_t* words)> RowConsumer;
+
+// eller's algorithm: builds a perfect maze one row of cells at a time, keeping only the
+// set label of each cell in the current row, so memory is O(width) however many rows are made
+class EllerGenerator
+{
+private:
+	int width; // cells per row
+	Rng rng;
+	uint64_t randomBits;
+	int bitsLeft;
+	std::vector<uint32_t> label;
+	std::vector<uint32_t> parent; // joins labels within the current row
+	std::vector<uint32_t> remaining;
+	std::vector<uint8_t> goesDown;
+	std::vector<uint32_t> freeLabels;
+	std::vector<uint64_t> cellRow;
+	std::vector<uint64_t> wallRow;
+
+	bool coin();
+	uint32_t find(uint32_t l);
+public:
+	EllerGenerator(int width, uint64_t seed);
+	int gridCols() const { return 2 * width + 1; }
+	int wordsPerRow() const { return (gridCols() + 63) / 64; }
+	// streams 2 * rows + 1 grid rows of gridCols() columns to consumer, top row first
+	void generate(int rows, const RowConsumer& consumer);
+};
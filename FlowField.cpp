@@ -0,0 +1,123 @@
+#include "FlowField.h"
+#include "MazeSolver.h"
+#include <algorithm>
+
+FlowField::FlowField(const MazeGrid& grid, int targetRow, int targetCol, unsigned threads) : grid(&grid), nCellRows(cellsAlong(grid.rows())),
+	nCellCols(cellsAlong(grid.cols())), dirs((size_t)nCellRows * nCellCols, UNREACHABLE), targetCell(0), perfect(false), threads(threads)
+{
+	if (dirs.empty())
+	{
+		return;
+	}
+	targetCell = cellIndex(targetRow, targetCol);
+	integrate();
+	// a connected maze with one passage fewer than cells has no loops
+	uint64_t passages = 0;
+	for (int r = 0; r < nCellRows; r++)
+	{
+		for (int c = 0; c < nCellCols; c++)
+		{
+			passages += (c + 1 < nCellCols && grid.isOpen(2 * r + 1, 2 * c + 2)) + (r + 1 < nCellRows && grid.isOpen(2 * r + 2, 2 * c + 1));
+		}
+	}
+	perfect = passages + 1 == dirs.size() && std::find(dirs.begin(), dirs.end(), UNREACHABLE) == dirs.end();
+}
+
+uint32_t FlowField::cellIndex(int row, int col) const
+{
+	return (uint32_t)cellAt(row, nCellRows) * nCellCols + cellAt(col, nCellCols);
+}
+
+void FlowField::integrate()
+{
+	// one distance field towards the target, then each cell points down it
+	int targetRow = 2 * (targetCell / nCellCols) + 1, targetCol = 2 * (targetCell % nCellCols) + 1;
+	MazeSolver solver(*grid, targetRow, targetCol, threads);
+	for (int r = 0; r < nCellRows; r++)
+	{
+		for (int c = 0; c < nCellCols; c++)
+		{
+			direction d;
+			uint8_t& dir = dirs[(size_t)r * nCellCols + c];
+			if (solver.hint(2 * r + 1, 2 * c + 1, d))
+			{
+				dir = d;
+			}
+			else
+			{
+				dir = solver.distance(2 * r + 1, 2 * c + 1) == 0 ? AT_TARGET : UNREACHABLE;
+			}
+		}
+	}
+}
+
+size_t FlowField::retarget(int targetRow, int targetCol)
+{
+	if (dirs.empty())
+	{
+		return 0;
+	}
+	uint32_t cell = cellIndex(targetRow, targetCol);
+	if (cell == targetCell)
+	{
+		return 0;
+	}
+	if (!perfect)
+	{
+		targetCell = cell;
+		integrate();
+		return dirs.size();
+	}
+	// the old field leads from the new target to the old one; turn that path round
+	uint32_t from = cell;
+	uint8_t back = AT_TARGET;
+	size_t changed = 0;
+	while (true)
+	{
+		uint8_t dir = dirs[from];
+		dirs[from] = back;
+		changed++;
+		if (dir == AT_TARGET)
+		{
+			break;
+		}
+		back = (dir + 2) % 4;
+		from = (uint32_t)((int)from + DIRECTION_ROWS[dir] * nCellCols + DIRECTION_COLS[dir]);
+	}
+	targetCell = cell;
+	return changed;
+}
+
+FlowFieldCache::FlowFieldCache(const MazeGrid& grid, size_t capacity, unsigned threads) : grid(grid), capacity(std::max<size_t>(capacity, 1)), threads(threads)
+{
+}
+
+std::shared_ptr<const FlowField> FlowFieldCache::field(int targetRow, int targetCol)
+{
+	int r = cellAt(targetRow, cellsAlong(grid.rows())), c = cellAt(targetCol, cellsAlong(grid.cols()));
+	uint32_t key = (uint32_t)r * cellsAlong(grid.cols()) + c;
+	auto found = fields.find(key);
+	if (found != fields.end())
+	{
+		recent.splice(recent.begin(), recent, found->second.used);
+		return found->second.field;
+	}
+	std::shared_ptr<FlowField> made;
+	if (!recent.empty() && fields[recent.front()].field->isPerfect())
+	{
+		made = std::make_shared<FlowField>(*fields[recent.front()].field);
+		made->retarget(2 * r + 1, 2 * c + 1);
+	}
+	else
+	{
+		made = std::make_shared<FlowField>(grid, 2 * r + 1, 2 * c + 1, threads);
+	}
+	recent.push_front(key);
+	fields[key] = Entry{made, recent.begin()};
+	while (fields.size() > capacity)
+	{
+		fields.erase(recent.back());
+		recent.pop_back();
+	}
+	return made;
+}
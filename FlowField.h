@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Maze.h"
+#include "MazeGrid.h"
+
+// direction towards one target for every cell of a maze, so any number of agents chasing
+// that target look up their next step in constant time. built by one MazeSolver pass.
+// in a perfect maze the field is a tree rooted at the target, so moving the target only
+// reverses the directions on the path between the old and new target (two cells for a
+// one cell move); mazes with loops are integrated again. the grid must outlive the field
+class FlowField
+{
+private:
+	const MazeGrid* grid;
+	int nCellRows;
+	int nCellCols;
+	std::vector<uint8_t> dirs; // a direction, or AT_TARGET / UNREACHABLE
+	uint32_t targetCell;
+	bool perfect;
+	unsigned threads;
+
+	uint32_t cellIndex(int row, int col) const;
+	void integrate();
+public:
+	static constexpr uint8_t AT_TARGET = 4;
+	static constexpr uint8_t UNREACHABLE = 5;
+
+	FlowField(const MazeGrid& grid, int targetRow, int targetCol, unsigned threads = 0);
+
+	// the way towards the target from the cell at row, col, false at the target or if it cannot be reached
+	bool towards(int row, int col, direction& d) const
+	{
+		if (dirs.empty())
+		{
+			return false;
+		}
+		uint8_t dir = dirs[cellIndex(row, col)];
+		d = static_cast<direction>(dir & 3);
+		return dir < AT_TARGET;
+	}
+	std::pair<int, int> target() const
+	{
+		if (dirs.empty())
+		{
+			return {1, 1};
+		}
+		return {2 * (int)(targetCell / nCellCols) + 1, 2 * (int)(targetCell % nCellCols) + 1};
+	}
+	// true when every cell is connected to every other by exactly one path
+	bool isPerfect() const { return perfect; }
+	// moves the target, cells changed in place. returns the number of cells rewritten
+	size_t retarget(int targetRow, int targetCol);
+};
+
+// flow fields for several targets, the least recently used dropped past capacity. a target
+// not held yet is derived from the most recently used field when the maze is perfect,
+// otherwise integrated from scratch. not safe to call from several threads at once, the
+// returned fields are
+class FlowFieldCache
+{
+private:
+	struct Entry
+	{
+		std::shared_ptr<const FlowField> field;
+		std::list<uint32_t>::iterator used;
+	};
+	const MazeGrid& grid;
+	size_t capacity;
+	unsigned threads;
+	std::unordered_map<uint32_t, Entry> fields;
+	std::list<uint32_t> recent; // most recently used first
+public:
+	FlowFieldCache(const MazeGrid& grid, size_t capacity, unsigned threads = 0);
+	std::shared_ptr<const FlowField> field(int targetRow, int targetCol);
+	size_t size() const { return fields.size(); }
+};
@@ -0,0 +1,351 @@
+#include "HierarchicalPathfinder.h"
+#include "Maze.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+HierarchicalPathfinder::HierarchicalPathfinder(const MazeGrid& grid, unsigned threads) : grid(grid), nCellRows(cellsAlong(grid.rows())),
+	nCellCols(cellsAlong(grid.cols())), clusterRows((nCellRows + CLUSTER_CELLS - 1) / CLUSTER_CELLS),
+	clusterCols((nCellCols + CLUSTER_CELLS - 1) / CLUSTER_CELLS), clusters((size_t)clusterRows * clusterCols), ids(0), query(0)
+{
+	ThreadPool pool(threads);
+	pool.parallelFor(clusters.size(), [&](size_t cluster)
+	{
+		buildCluster(cluster);
+	});
+	for (Cluster& cluster : clusters)
+	{
+		cluster.base = ids;
+		cluster.capacity = cluster.entrances.size();
+		ids += cluster.capacity;
+	}
+}
+
+uint32_t HierarchicalPathfinder::cellIndex(int row, int col) const
+{
+	return (uint32_t)cellAt(row, nCellRows) * nCellCols + cellAt(col, nCellCols);
+}
+
+int HierarchicalPathfinder::clusterOf(uint32_t cell) const
+{
+	return (cell / nCellCols / CLUSTER_CELLS) * clusterCols + (cell % nCellCols) / CLUSTER_CELLS;
+}
+
+int HierarchicalPathfinder::localIndex(uint32_t cell) const
+{
+	// position inside the cluster, as used by localSearch
+	return (cell / nCellCols % CLUSTER_CELLS) * CLUSTER_CELLS + cell % nCellCols % CLUSTER_CELLS;
+}
+
+bool HierarchicalPathfinder::passage(uint32_t cell, int d) const
+{
+	// passage out of cell towards d, passages out of the maze do not count
+	int r = cell / nCellCols + DIRECTION_ROWS[d];
+	int c = cell % nCellCols + DIRECTION_COLS[d];
+	return r >= 0 && c >= 0 && r < nCellRows && c < nCellCols && grid.isOpen(2 * r + 1 - DIRECTION_ROWS[d], 2 * c + 1 - DIRECTION_COLS[d]);
+}
+
+std::vector<uint32_t> HierarchicalPathfinder::findEntrances(int cluster) const
+{
+	// cells of the cluster with a passage into another cluster, in cell order
+	std::vector<uint32_t> found;
+	int top = (cluster / clusterCols) * CLUSTER_CELLS, left = (cluster % clusterCols) * CLUSTER_CELLS;
+	int bottom = std::min(top + CLUSTER_CELLS, nCellRows), right = std::min(left + CLUSTER_CELLS, nCellCols);
+	for (int r = top; r < bottom; r++)
+	{
+		// only the first and last rows look at every cell
+		int step = r == top || r == bottom - 1 ? 1 : std::max(right - 1 - left, 1);
+		for (int c = left; c < right; c += step)
+		{
+			uint32_t cell = (uint32_t)r * nCellCols + c;
+			if ((r == top && passage(cell, 0)) || (c == right - 1 && passage(cell, 1)) || (r == bottom - 1 && passage(cell, 2)) || (c == left && passage(cell, 3)))
+			{
+				found.push_back(cell);
+			}
+		}
+	}
+	return found;
+}
+
+void HierarchicalPathfinder::buildCluster(int cluster)
+{
+	Cluster& built = clusters[cluster];
+	built.entrances = findEntrances(cluster);
+	built.linkStart.assign(1, 0);
+	built.links.clear();
+	uint8_t sides[CLUSTER_CELLS * CLUSTER_CELLS];
+	clusterSides(cluster, sides);
+	std::vector<uint32_t> dist;
+	for (size_t i = 0; i < built.entrances.size(); i++)
+	{
+		localSearch(built.entrances[i], sides, dist, nullptr);
+		for (size_t j = 0; j < built.entrances.size(); j++)
+		{
+			uint32_t length = dist[localIndex(built.entrances[j])];
+			if (j != i && length != UNREACHED)
+			{
+				built.links.push_back(Link{(uint32_t)j, length});
+			}
+		}
+		built.linkStart.push_back(built.links.size());
+	}
+}
+
+void HierarchicalPathfinder::clusterSides(int cluster, uint8_t* sides) const
+{
+	// bit d set when a passage leads from the cell towards d to a cell of the same cluster,
+	// indexed by localIndex, so the searches inside a cluster do not go back to the grid
+	int top = (cluster / clusterCols) * CLUSTER_CELLS, left = (cluster % clusterCols) * CLUSTER_CELLS;
+	int bottom = std::min(top + CLUSTER_CELLS, nCellRows), right = std::min(left + CLUSTER_CELLS, nCellCols);
+	std::fill(sides, sides + CLUSTER_CELLS * CLUSTER_CELLS, 0);
+	for (int r = top; r < bottom; r++)
+	{
+		for (int c = left; c < right; c++)
+		{
+			int local = (r - top) * CLUSTER_CELLS + c - left;
+			if (c + 1 < right && grid.isOpen(2 * r + 1, 2 * c + 2))
+			{
+				sides[local] |= 1 << 1;
+				sides[local + 1] |= 1 << 3;
+			}
+			if (r + 1 < bottom && grid.isOpen(2 * r + 2, 2 * c + 1))
+			{
+				sides[local] |= 1 << 2;
+				sides[local + CLUSTER_CELLS] |= 1 << 0;
+			}
+		}
+	}
+}
+
+void HierarchicalPathfinder::localSearch(uint32_t from, const uint8_t* sides, std::vector<uint32_t>& dist, std::vector<uint8_t>* parent) const
+{
+	// BFS that stays inside the cluster of from, over its clusterSides. dist and parent
+	// (the direction each cell was reached in) are indexed by localIndex
+	const int LOCAL_STEPS[] = {-CLUSTER_CELLS, 1, CLUSTER_CELLS, -1};
+	dist.assign(CLUSTER_CELLS * CLUSTER_CELLS, UNREACHED);
+	if (parent)
+	{
+		parent->assign(CLUSTER_CELLS * CLUSTER_CELLS, 0);
+	}
+	uint16_t queue[CLUSTER_CELLS * CLUSTER_CELLS];
+	int head = 0, tail = 0;
+	queue[tail++] = localIndex(from);
+	dist[localIndex(from)] = 0;
+	while (head < tail)
+	{
+		int local = queue[head++];
+		for (int d = 0; d < 4; d++)
+		{
+			int next = local + LOCAL_STEPS[d];
+			if (((sides[local] >> d) & 1) && dist[next] == UNREACHED)
+			{
+				dist[next] = dist[local] + 1;
+				if (parent)
+				{
+					(*parent)[next] = d;
+				}
+				queue[tail++] = next;
+			}
+		}
+	}
+}
+
+std::vector<uint32_t> HierarchicalPathfinder::localPath(uint32_t from, uint32_t to) const
+{
+	// cells from one to the other inside their cluster, both ends included
+	uint8_t sides[CLUSTER_CELLS * CLUSTER_CELLS];
+	clusterSides(clusterOf(from), sides);
+	std::vector<uint32_t> dist;
+	std::vector<uint8_t> parent;
+	localSearch(from, sides, dist, &parent);
+	std::vector<uint32_t> cells{to};
+	while (cells.back() != from)
+	{
+		uint32_t cell = cells.back();
+		int d = parent[localIndex(cell)];
+		cells.push_back((uint32_t)((int)cell - DIRECTION_ROWS[d] * nCellCols - DIRECTION_COLS[d]));
+	}
+	std::reverse(cells.begin(), cells.end());
+	return cells;
+}
+
+size_t HierarchicalPathfinder::entranceCount() const
+{
+	size_t count = 0;
+	for (const Cluster& cluster : clusters)
+	{
+		count += cluster.entrances.size();
+	}
+	return count;
+}
+
+void HierarchicalPathfinder::updateCluster(int clusterRow, int clusterCol)
+{
+	auto rebuild = [&](int cluster)
+	{
+		// ids stay put unless the cluster outgrows them, then it moves to fresh ones
+		Cluster& rebuilt = clusters[cluster];
+		buildCluster(cluster);
+		if (rebuilt.entrances.size() > rebuilt.capacity)
+		{
+			rebuilt.base = ids;
+			rebuilt.capacity = rebuilt.entrances.size();
+			ids += rebuilt.capacity;
+		}
+	};
+	rebuild(clusterRow * clusterCols + clusterCol);
+	for (int d = 0; d < 4; d++)
+	{
+		int r = clusterRow + DIRECTION_ROWS[d], c = clusterCol + DIRECTION_COLS[d];
+		if (r < 0 || c < 0 || r >= clusterRows || c >= clusterCols)
+		{
+			continue;
+		}
+		int neighbour = r * clusterCols + c;
+		if (findEntrances(neighbour) != clusters[neighbour].entrances)
+		{
+			rebuild(neighbour);
+		}
+	}
+}
+
+uint32_t HierarchicalPathfinder::search(uint32_t from, uint32_t to, std::vector<uint32_t>* hops) const
+{
+	// A* over the entrances, seeded with the entrances of the start cluster and finished
+	// from any entrance of the goal cluster. hops gets the entrance cells of the best path,
+	// left empty when it never leaves the start cluster
+	int fromCluster = clusterOf(from), toCluster = clusterOf(to);
+	uint8_t sides[CLUSTER_CELLS * CLUSTER_CELLS];
+	std::vector<uint32_t> fromDist, toDist;
+	clusterSides(fromCluster, sides);
+	localSearch(from, sides, fromDist, nullptr);
+	clusterSides(toCluster, sides);
+	localSearch(to, sides, toDist, nullptr);
+	uint32_t best = fromCluster == toCluster ? fromDist[localIndex(to)] : UNREACHED;
+	uint32_t last = SEED;
+
+	states.resize(ids);
+	open.clear();
+	query++;
+	int toRow = to / nCellCols, toCol = to % nCellCols;
+	auto reach = [&](uint32_t id, uint32_t cell, uint32_t g, uint32_t via)
+	{
+		SearchState& state = states[id];
+		if (state.stamp != query || g < state.cost)
+		{
+			state = SearchState{g, via, query, cell};
+			uint32_t h = std::abs((int)(cell / nCellCols) - toRow) + std::abs((int)(cell % nCellCols) - toCol);
+			open.push_back((uint64_t)(g + h) << 32 | id);
+			std::push_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		}
+	};
+	const Cluster& start = clusters[fromCluster];
+	for (size_t i = 0; i < start.entrances.size(); i++)
+	{
+		uint32_t g = fromDist[localIndex(start.entrances[i])];
+		if (g != UNREACHED)
+		{
+			reach(start.base + i, start.entrances[i], g, SEED);
+		}
+	}
+	while (!open.empty())
+	{
+		uint64_t top = open.front();
+		std::pop_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		open.pop_back();
+		if ((top >> 32) >= best)
+		{
+			break;
+		}
+		uint32_t id = (uint32_t)top;
+		const SearchState state = states[id];
+		uint32_t h = std::abs((int)(state.cell / nCellCols) - toRow) + std::abs((int)(state.cell % nCellCols) - toCol);
+		if (state.cost + h != (top >> 32))
+		{
+			continue; // reached more cheaply since
+		}
+		int cluster = clusterOf(state.cell);
+		const Cluster& here = clusters[cluster];
+		if (cluster == toCluster && toDist[localIndex(state.cell)] != UNREACHED && state.cost + toDist[localIndex(state.cell)] < best)
+		{
+			best = state.cost + toDist[localIndex(state.cell)];
+			last = id;
+		}
+		// across the border, then to the other entrances of the cluster
+		for (int d = 0; d < 4; d++)
+		{
+			uint32_t next = (uint32_t)((int)state.cell + DIRECTION_ROWS[d] * nCellCols + DIRECTION_COLS[d]);
+			if (passage(state.cell, d) && clusterOf(next) != cluster)
+			{
+				const Cluster& there = clusters[clusterOf(next)];
+				size_t j = std::lower_bound(there.entrances.begin(), there.entrances.end(), next) - there.entrances.begin();
+				reach(there.base + j, next, state.cost + 1, id);
+			}
+		}
+		uint32_t i = id - here.base;
+		for (uint32_t l = here.linkStart[i]; l < here.linkStart[i + 1]; l++)
+		{
+			const Link& link = here.links[l];
+			reach(here.base + link.to, here.entrances[link.to], state.cost + link.length, id);
+		}
+	}
+	if (hops)
+	{
+		hops->clear();
+		for (uint32_t id = last; id != SEED; id = states[id].via)
+		{
+			hops->push_back(states[id].cell);
+		}
+		std::reverse(hops->begin(), hops->end());
+	}
+	return best;
+}
+
+uint32_t HierarchicalPathfinder::distance(int fromRow, int fromCol, int toRow, int toCol) const
+{
+	if (clusters.empty())
+	{
+		return UNREACHED;
+	}
+	return search(cellIndex(fromRow, fromCol), cellIndex(toRow, toCol), nullptr);
+}
+
+std::vector<std::pair<int, int>> HierarchicalPathfinder::path(int fromRow, int fromCol, int toRow, int toCol) const
+{
+	std::vector<std::pair<int, int>> steps;
+	if (clusters.empty())
+	{
+		return steps;
+	}
+	uint32_t from = cellIndex(fromRow, fromCol), to = cellIndex(toRow, toCol);
+	std::vector<uint32_t> hops;
+	if (search(from, to, &hops) == UNREACHED)
+	{
+		return steps;
+	}
+	// each hop is either across a border or through one cluster
+	hops.insert(hops.begin(), from);
+	hops.push_back(to);
+	std::vector<uint32_t> cells{from};
+	for (size_t i = 1; i < hops.size(); i++)
+	{
+		if (clusterOf(hops[i - 1]) != clusterOf(hops[i]))
+		{
+			cells.push_back(hops[i]);
+			continue;
+		}
+		std::vector<uint32_t> stretch = localPath(hops[i - 1], hops[i]);
+		cells.insert(cells.end(), stretch.begin() + 1, stretch.end());
+	}
+	for (size_t i = 0; i < cells.size(); i++)
+	{
+		int r = 2 * (cells[i] / nCellCols) + 1, c = 2 * (cells[i] % nCellCols) + 1;
+		if (i > 0)
+		{
+			steps.push_back({(r + steps.back().first) / 2, (c + steps.back().second) / 2});
+		}
+		steps.push_back({r, c});
+	}
+	return steps;
+}
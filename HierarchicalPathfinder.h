@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "MazeGrid.h"
+
+// cells per side of a pathfinding cluster, the same as a ChunkWorld chunk
+const int CLUSTER_CELLS = 16;
+
+// hierarchical pathfinding (HPA*) over a large maze. the cells are split into clusters;
+// every passage across a cluster border makes an entrance on both sides, and the distances
+// between the entrances of a cluster, staying inside it, are found by small BFS runs, all
+// clusters in parallel. a query searches the graph of entrances with A* and then fills in
+// each hop by a BFS inside one cluster. as any path is a chain of in-cluster stretches
+// joined by border crossings, the distances are exact. the grid must outlive the
+// pathfinder; after walls change, updateCluster rebuilds only what they touch.
+class HierarchicalPathfinder
+{
+public:
+	static constexpr uint32_t UNREACHED = 0xffffffffu;
+private:
+	// entrance j of a cluster reachable inside it from the entrance owning the link
+	struct Link
+	{
+		uint32_t to;
+		uint32_t length;
+	};
+	struct Cluster
+	{
+		std::vector<uint32_t> entrances; // cell indices, sorted
+		std::vector<uint32_t> linkStart; // links of entrance i are links[linkStart[i]..linkStart[i + 1])
+		std::vector<Link> links;
+		uint32_t base;     // id of the first entrance, the rest follow
+		uint32_t capacity; // ids reserved from base
+	};
+	const MazeGrid& grid;
+	int nCellRows;
+	int nCellCols;
+	int clusterRows;
+	int clusterCols;
+	std::vector<Cluster> clusters;
+	uint32_t ids;
+	// A* scratch per entrance id, valid when its stamp is the current query
+	struct SearchState
+	{
+		uint32_t cost;
+		uint32_t via; // entrance id that reached this one, or SEED
+		uint32_t stamp;
+		uint32_t cell;
+	};
+	mutable std::vector<SearchState> states;
+	mutable std::vector<uint64_t> open; // estimated total << 32 | entrance id, a min heap
+	mutable uint32_t query;
+
+	static constexpr uint32_t SEED = 0xffffffffu;
+
+	uint32_t cellIndex(int row, int col) const;
+	int clusterOf(uint32_t cell) const;
+	int localIndex(uint32_t cell) const;
+	bool passage(uint32_t cell, int d) const;
+	std::vector<uint32_t> findEntrances(int cluster) const;
+	void buildCluster(int cluster);
+	void clusterSides(int cluster, uint8_t* sides) const;
+	void localSearch(uint32_t from, const uint8_t* sides, std::vector<uint32_t>& dist, std::vector<uint8_t>* parent) const;
+	std::vector<uint32_t> localPath(uint32_t from, uint32_t to) const;
+	uint32_t search(uint32_t from, uint32_t to, std::vector<uint32_t>* hops) const;
+public:
+	explicit HierarchicalPathfinder(const MazeGrid& grid, unsigned threads = 0);
+
+	size_t clusterCount() const { return clusters.size(); }
+	size_t entranceCount() const;
+	// rebuild after walls changed inside cluster (clusterRow, clusterCol) or on its border.
+	// a neighbour is rebuilt as well only if the passages across their shared border changed
+	void updateCluster(int clusterRow, int clusterCol);
+
+	// cell steps between the two positions, UNREACHED if they are not connected
+	uint32_t distance(int fromRow, int fromCol, int toRow, int toCol) const;
+	// grid positions from one to the other, passages included, empty if not connected
+	std::vector<std::pair<int, int>> path(int fromRow, int fromCol, int toRow, int toCol) const;
+};
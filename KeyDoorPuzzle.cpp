@@ -0,0 +1,293 @@
+#include "KeyDoorPuzzle.h"
+#include "Maze.h"
+#include "MazeSolver.h"
+#include "Rng.h"
+#include <algorithm>
+#include <iostream>
+
+KeyDoorPuzzle::KeyDoorPuzzle(const MazeGrid& grid, int fromRow, int fromCol, int toRow, int toCol) : nCellRows(cellsAlong(grid.rows())),
+	nCellCols(cellsAlong(grid.cols())), sides((size_t)nCellRows * nCellCols, 0), doorSides(sides.size(), 0), doorKeys(2 * sides.size(), 0),
+	keyBits(sides.size(), 0), visited(1 << MAX_KEYS), queues(1 << MAX_KEYS),
+	sources(1 << MAX_KEYS), states(0)
+{
+	start = goal = 0;
+	if (sides.empty())
+	{
+		return;
+	}
+	start = cellIndex(fromRow, fromCol);
+	goal = cellIndex(toRow, toCol);
+	for (int r = 0; r < nCellRows; r++)
+	{
+		for (int c = 0; c < nCellCols; c++)
+		{
+			for (int d = 0; d < 4; d++)
+			{
+				int nr = r + DIRECTION_ROWS[d], nc = c + DIRECTION_COLS[d];
+				if (nr >= 0 && nc >= 0 && nr < nCellRows && nc < nCellCols && grid.isOpen(2 * r + 1 + DIRECTION_ROWS[d], 2 * c + 1 + DIRECTION_COLS[d]))
+				{
+					sides[(size_t)r * nCellCols + c] |= 1 << d;
+				}
+			}
+		}
+	}
+	// passages a door can block the way without keys on
+	MazeSolver solver(grid, 2 * (goal / nCellCols) + 1, 2 * (goal % nCellCols) + 1, 1);
+	if (solver.distance(fromRow, fromCol) != MazeSolver::UNREACHED)
+	{
+		std::vector<std::pair<int, int>> path = solver.path(2 * (start / nCellCols) + 1, 2 * (start % nCellCols) + 1);
+		for (size_t i = 1; i < path.size(); i += 2)
+		{
+			solutionPassages.push_back(path[i]);
+		}
+	}
+}
+
+uint32_t KeyDoorPuzzle::cellIndex(int row, int col) const
+{
+	return (uint32_t)cellAt(row, nCellRows) * nCellCols + cellAt(col, nCellCols);
+}
+
+void KeyDoorPuzzle::clearLayout()
+{
+	for (const std::pair<int, int>& key : keys)
+	{
+		keyBits[cellIndex(key.first, key.second)] = 0;
+	}
+	for (const Door& door : doors)
+	{
+		// the cell west or north of the passage and the one past it
+		uint32_t cell = cellIndex(door.row, door.col);
+		bool east = door.row % 2 == 1;
+		doorSides[cell] &= east ? ~(1 << 1) : ~(1 << 2);
+		doorSides[east ? cell + 1 : cell + nCellCols] &= east ? ~(1 << 3) : ~(1 << 0);
+	}
+	keys.clear();
+	doors.clear();
+}
+
+int KeyDoorPuzzle::doorKey(uint32_t cell, int d) const
+{
+	// doors north and west of a cell are stored with the cell before
+	switch (d)
+	{
+	case 0:
+		return doorKeys[2 * (cell - nCellCols) + 1];
+	case 1:
+		return doorKeys[2 * cell];
+	case 2:
+		return doorKeys[2 * cell + 1];
+	default:
+		return doorKeys[2 * (cell - 1)];
+	}
+}
+
+bool KeyDoorPuzzle::setLayout(const std::vector<std::pair<int, int>>& keys, const std::vector<Door>& doors)
+{
+	clearLayout();
+	if (keys.size() > (size_t)MAX_KEYS)
+	{
+		std::cout << "At most " << MAX_KEYS << " keys, not " << keys.size() << std::endl;
+		return false;
+	}
+	if (sides.empty() && (!keys.empty() || !doors.empty()))
+	{
+		std::cout << "No cells to lay keys and doors on" << std::endl;
+		return false;
+	}
+	for (const Door& door : doors)
+	{
+		bool east = door.row % 2 == 1 && door.col % 2 == 0;
+		bool south = door.row % 2 == 0 && door.col % 2 == 1;
+		uint32_t cell = cellIndex(door.row, door.col);
+		if ((!east && !south) || door.row < 1 || door.col < 1 || door.row > 2 * nCellRows || door.col > 2 * nCellCols ||
+			door.key < 0 || door.key >= (int)keys.size() || !((sides[cell] >> (east ? 1 : 2)) & 1))
+		{
+			std::cout << "No open passage for a door at " << door.row << ", " << door.col << std::endl;
+			clearLayout();
+			return false;
+		}
+		doorSides[cell] |= east ? 1 << 1 : 1 << 2;
+		doorSides[east ? cell + 1 : cell + nCellCols] |= east ? 1 << 3 : 1 << 0;
+		doorKeys[2 * cell + (east ? 0 : 1)] = door.key;
+		this->doors.push_back(door);
+	}
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		keyBits[cellIndex(keys[i].first, keys[i].second)] |= 1 << i;
+	}
+	this->keys = keys;
+	return true;
+}
+
+int KeyDoorPuzzle::doorAt(int row, int col) const
+{
+	for (const Door& door : doors)
+	{
+		if (door.row == row && door.col == col)
+		{
+			return door.key;
+		}
+	}
+	return -1;
+}
+
+bool KeyDoorPuzzle::solvable() const
+{
+	if (sides.empty())
+	{
+		states = 0;
+		return false;
+	}
+	size_t words = (sides.size() + 63) / 64;
+	int masks = 1 << keys.size();
+	for (int mask = 0; mask < masks; mask++)
+	{
+		if (!queues[mask].empty())
+		{
+			// only masks reached last time have bits to clear
+			std::fill(visited[mask].begin(), visited[mask].end(), 0);
+			queues[mask].clear();
+			sources[mask].clear();
+		}
+	}
+	states = 0;
+	auto isSeen = [](const std::vector<uint64_t>& seen, uint32_t cell)
+	{
+		return (seen[cell >> 6] >> (cell & 63)) & 1;
+	};
+	auto reach = [&](uint32_t cell, int mask, int from)
+	{
+		if (from >= 0 && (sources[mask].empty() || sources[mask].back() != from))
+		{
+			sources[mask].push_back(from);
+		}
+		std::vector<uint64_t>& seen = visited[mask];
+		if (seen.empty())
+		{
+			seen.assign(words, 0);
+		}
+		uint64_t bit = uint64_t(1) << (cell & 63);
+		if (!(seen[cell >> 6] & bit))
+		{
+			seen[cell >> 6] |= bit;
+			queues[mask].push_back(cell);
+		}
+	};
+	const int steps[] = {-nCellCols, 1, nCellCols, -1};
+	reach(start, keyBits[start], -1);
+	// picking up a key only moves to a larger mask, so each mask is done once its turn comes
+	for (int mask = 0; mask < masks; mask++)
+	{
+		std::vector<uint32_t>& queue = queues[mask];
+		if (queue.empty())
+		{
+			continue;
+		}
+		for (int from : sources[mask])
+		{
+			for (size_t i = 0; i < words; i++)
+			{
+				visited[mask][i] |= visited[from][i];
+			}
+		}
+		if (!sources[mask].empty())
+		{
+			// cells taken over may now open a door or step onto a key
+			for (const Door& door : doors)
+			{
+				uint32_t cell = cellIndex(door.row, door.col);
+				uint32_t past = door.row % 2 == 1 ? cell + 1 : cell + nCellCols;
+				for (uint32_t side : {cell, past})
+				{
+					if (isSeen(visited[mask], side))
+					{
+						queue.push_back(side);
+					}
+				}
+			}
+			for (const std::pair<int, int>& key : keys)
+			{
+				uint32_t cell = cellIndex(key.first, key.second);
+				for (unsigned open = sides[cell]; open; open &= open - 1)
+				{
+					uint32_t next = cell + steps[__builtin_ctz(open)];
+					if (isSeen(visited[mask], next))
+					{
+						queue.push_back(next);
+					}
+				}
+			}
+		}
+		uint64_t* seen = visited[mask].data();
+		for (size_t head = 0; head < queue.size(); head++)
+		{
+			uint32_t cell = queue[head];
+			if (cell == goal)
+			{
+				states += head + 1;
+				return true;
+			}
+			unsigned open = sides[cell];
+			for (unsigned locked = doorSides[cell]; locked; locked &= locked - 1)
+			{
+				int d = __builtin_ctz(locked);
+				if (!((mask >> doorKey(cell, d)) & 1))
+				{
+					open &= ~(1u << d);
+				}
+			}
+			for (; open; open &= open - 1)
+			{
+				uint32_t next = cell + steps[__builtin_ctz(open)];
+				if (keyBits[next] & ~mask)
+				{
+					reach(next, mask | keyBits[next], mask);
+				}
+				else if (!((seen[next >> 6] >> (next & 63)) & 1))
+				{
+					seen[next >> 6] |= uint64_t(1) << (next & 63);
+					queue.push_back(next);
+				}
+			}
+		}
+		states += queue.size();
+	}
+	return false;
+}
+
+int KeyDoorPuzzle::placeRandom(int keyCount, uint64_t seed, int tries)
+{
+	if (keyCount > MAX_KEYS || (size_t)keyCount > solutionPassages.size())
+	{
+		std::cout << "No room for " << keyCount << " doors on the solution" << std::endl;
+		return 0;
+	}
+	Rng rng(seed);
+	std::vector<std::pair<int, int>> keys(keyCount);
+	std::vector<Door> doors(keyCount);
+	std::vector<uint32_t> picked;
+	for (int tried = 1; tried <= tries; tried++)
+	{
+		picked.clear();
+		while ((int)picked.size() < keyCount)
+		{
+			uint32_t passage = rng.below(solutionPassages.size());
+			if (std::find(picked.begin(), picked.end(), passage) == picked.end())
+			{
+				picked.push_back(passage);
+			}
+		}
+		for (int i = 0; i < keyCount; i++)
+		{
+			doors[i] = Door{solutionPassages[picked[i]].first, solutionPassages[picked[i]].second, i};
+			keys[i] = {2 * (int)rng.below(nCellRows) + 1, 2 * (int)rng.below(nCellCols) + 1};
+		}
+		if (setLayout(keys, doors) && solvable())
+		{
+			return tried;
+		}
+	}
+	clearLayout();
+	return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "MazeGrid.h"
+
+// keys per level; the keys held are a bitmask and each mask gets its own visited bitset
+const int MAX_KEYS = 8;
+
+// keys and locked doors laid over a maze. a door sits on a passage and only lets through
+// someone holding its key, keys lie on cells and are picked up by walking onto them.
+// solvable() is a BFS over (cell, keys held) states with one bitset of cells per key mask.
+// keys are only ever gained, so the masks are searched in increasing order and every
+// state is visited once. with more keys one can always walk back to where fewer got, so a
+// mask starts from the cells of the masks it was reached from and only searches on from
+// the cells next to doors and keys, instead of flooding them all again. doors are given at
+// their passage, keys, start and goal at any grid position
+class KeyDoorPuzzle
+{
+public:
+	struct Door
+	{
+		int row; // the passage, odd row and even column or the other way round
+		int col;
+		int key;
+	};
+private:
+	int nCellRows;
+	int nCellCols;
+	uint32_t start;
+	uint32_t goal;
+	std::vector<uint8_t> sides;     // per cell, bit d set when the passage towards d is open
+	std::vector<uint8_t> doorSides; // per cell, bit d set when that passage has a door
+	std::vector<uint8_t> doorKeys;  // per cell, keys of the doors east and south of it
+	std::vector<uint8_t> keyBits;   // per cell, the key lying there as a mask bit
+	std::vector<std::pair<int, int>> keys;
+	std::vector<Door> doors;
+	std::vector<std::pair<int, int>> solutionPassages;
+	mutable std::vector<std::vector<uint64_t>> visited; // per key mask, one bit per cell
+	mutable std::vector<std::vector<uint32_t>> queues;  // per key mask
+	mutable std::vector<std::vector<int>> sources;      // per key mask, smaller masks a key led from
+	mutable size_t states;
+
+	uint32_t cellIndex(int row, int col) const;
+	void clearLayout();
+	int doorKey(uint32_t cell, int d) const;
+public:
+	KeyDoorPuzzle(const MazeGrid& grid, int fromRow, int fromCol, int toRow, int toCol);
+
+	// replaces keys and doors, key i opens every door with key i. false, with nothing laid,
+	// if there are more than MAX_KEYS keys or a door is not on an open passage
+	bool setLayout(const std::vector<std::pair<int, int>>& keys, const std::vector<Door>& doors);
+	const std::vector<std::pair<int, int>>& getKeys() const { return keys; }
+	const std::vector<Door>& getDoors() const { return doors; }
+	// key of the door at a passage, -1 if there is none
+	int doorAt(int row, int col) const;
+
+	// whether the goal can be reached from the start, picking up keys on the way
+	bool solvable() const;
+	// (cell, keys held) states the last solvable() visited
+	size_t statesVisited() const { return states; }
+	// lays keyCount doors on distinct passages of the keyless solution, so each one blocks
+	// it, and their keys on random cells, until a layout is solvable. returns the layouts
+	// tried, the accepted one last, or 0 if none of tries was
+	int placeRandom(int keyCount, uint64_t seed, int tries);
+};
@@ -0,0 +1,160 @@
+#include "LevelFile.h"
+#include "Maze.h"
+#include <climits>
+#include <cstring>
+#include <iostream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LEVEL_MMAP 1
+#endif
+
+uint64_t levelChecksum(const uint64_t* words, size_t count, uint64_t state)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		state = (state ^ (words[i] * 0x9e3779b97f4a7c15ull)) * 0xbf58476d1ce4e5b9ull;
+		state ^= state >> 29;
+	}
+	return state;
+}
+
+LevelWriter::LevelWriter(const std::string& path, int rows, int cols, uint64_t seed, uint32_t generatorId) :
+	path(path), file(path, std::ios::binary | std::ios::trunc), header{}, checksum(LEVEL_CHECKSUM_START), rowsWritten(0)
+{
+	std::memcpy(header.magic, LEVEL_MAGIC, sizeof(header.magic));
+	header.version = LEVEL_VERSION;
+	header.rows = rows;
+	header.cols = cols;
+	header.wordsPerRow = (cols + 63) / 64;
+	header.generatorId = generatorId;
+	header.seed = seed;
+	header.payloadOffset = LEVEL_PAYLOAD_OFFSET;
+	// placeholder until finish knows the checksum
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void LevelWriter::writeRow(const uint64_t* words)
+{
+	checksum = levelChecksum(words, header.wordsPerRow, checksum);
+	file.write(reinterpret_cast<const char*>(words), header.wordsPerRow * sizeof(uint64_t));
+	rowsWritten++;
+}
+
+bool LevelWriter::finish()
+{
+	if (rowsWritten != header.rows)
+	{
+		std::cout << "Level " << path << " got " << rowsWritten << " of " << header.rows << " rows" << std::endl;
+		return false;
+	}
+	header.checksum = checksum;
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.close();
+	if (!file)
+	{
+		std::cout << "Failed to write level " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool writeLevel(const std::string& path, const MazeGrid& grid, uint64_t seed, uint32_t generatorId)
+{
+	LevelWriter writer(path, grid.rows(), grid.cols(), seed, generatorId);
+	for (int row = 0; row < grid.rows(); row++)
+	{
+		writer.writeRow(grid.row(row));
+	}
+	return writer.finish();
+}
+
+bool checkLevelHeader(const LevelHeader& header, uint64_t fileSize, const std::string& path)
+{
+	uint64_t payload = (uint64_t)header.rows * header.wordsPerRow * sizeof(uint64_t);
+	if (std::memcmp(header.magic, LEVEL_MAGIC, sizeof(header.magic)) != 0 || header.version != LEVEL_VERSION)
+	{
+		std::cout << "Not a level file: " << path << std::endl;
+		return false;
+	}
+	// the dimensions become MazeGrid ints, and a maze needs at least one cell
+	if (header.rows < 3 || header.cols < 3 || header.rows > INT_MAX || header.cols > INT_MAX)
+	{
+		std::cout << "Level file has bad dimensions " << header.rows << "x" << header.cols << ": " << path << std::endl;
+		return false;
+	}
+	if (header.wordsPerRow != (header.cols + 63) / 64 || header.payloadOffset != LEVEL_PAYLOAD_OFFSET || fileSize < header.payloadOffset + payload)
+	{
+		std::cout << "Level file is truncated or damaged: " << path << std::endl;
+		return false;
+	}
+	// the id becomes a generator on load, so it has to name one
+	if (header.generatorId >= GENERATOR_COUNT)
+	{
+		std::cout << "Level file names an unknown generator " << header.generatorId << ": " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool mapLevel(const std::string& path, MazeGrid& grid, LevelHeader& header, bool verify)
+{
+#ifdef LEVEL_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		std::cout << "Failed to open level " << path << std::endl;
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(LevelHeader))
+	{
+		close(fd);
+		std::cout << "Level file is truncated or damaged: " << path << std::endl;
+		return false;
+	}
+	size_t length = info.st_size;
+	void* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+	{
+		std::cout << "Failed to map level " << path << std::endl;
+		return false;
+	}
+	std::shared_ptr<void> mapping(base, [length](void* p) { munmap(p, length); });
+	std::memcpy(&header, base, sizeof(header));
+	if (!checkLevelHeader(header, length, path))
+	{
+		return false;
+	}
+	uint64_t* words = reinterpret_cast<uint64_t*>(static_cast<char*>(base) + header.payloadOffset);
+	MazeGrid view(header.rows, header.cols, words, mapping);
+#else
+	// no mmap, read the payload into an owned grid instead
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		std::cout << "Failed to open level " << path << std::endl;
+		return false;
+	}
+	uint64_t length = file.tellg();
+	file.seekg(0);
+	if (length < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) || !checkLevelHeader(header, length, path))
+	{
+		return false;
+	}
+	MazeGrid view(header.rows, header.cols);
+	file.seekg(header.payloadOffset);
+	file.read(reinterpret_cast<char*>(view.words()), view.wordCount() * sizeof(uint64_t));
+#endif
+	if (verify && levelChecksum(view.words(), view.wordCount()) != header.checksum)
+	{
+		std::cout << "Level checksum mismatch: " << path << std::endl;
+		return false;
+	}
+	grid = std::move(view);
+	return true;
+}
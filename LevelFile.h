@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "MazeGrid.h"
+
+// level files are a 64 byte header followed by the MazeGrid words exactly as they sit in
+// memory (little endian), so a mapped file can be used as a grid without parsing
+const char LEVEL_MAGIC[4] = {'G', 'L', 'M', 'Z'};
+const uint32_t LEVEL_VERSION = 1;
+const uint64_t LEVEL_PAYLOAD_OFFSET = 64;
+
+struct LevelHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t rows;
+	uint32_t cols;
+	uint32_t wordsPerRow;
+	uint32_t generatorId;
+	uint64_t seed;
+	uint64_t checksum; // levelChecksum of the payload
+	uint64_t payloadOffset;
+	uint64_t reserved[2];
+};
+static_assert(sizeof(LevelHeader) == LEVEL_PAYLOAD_OFFSET, "level header must fill the space before the payload");
+
+const uint64_t LEVEL_CHECKSUM_START = 0x6c8e9cf570932bd5ull;
+// running checksum over payload words, feed it chunks in order starting from LEVEL_CHECKSUM_START
+uint64_t levelChecksum(const uint64_t* words, size_t count, uint64_t state = LEVEL_CHECKSUM_START);
+
+// writes a level one grid row at a time, so levels larger than memory can be streamed to
+// disk (e.g. from EllerGenerator). the header is filled in by finish
+class LevelWriter
+{
+private:
+	std::string path;
+	std::ofstream file;
+	LevelHeader header;
+	uint64_t checksum;
+	uint32_t rowsWritten;
+public:
+	LevelWriter(const std::string& path, int rows, int cols, uint64_t seed, uint32_t generatorId);
+	void writeRow(const uint64_t* words);
+	bool finish();
+};
+
+bool writeLevel(const std::string& path, const MazeGrid& grid, uint64_t seed, uint32_t generatorId);
+// false, with the reason printed, if header does not describe a level that fits in fileSize
+// bytes or its generatorId names no generator
+bool checkLevelHeader(const LevelHeader& header, uint64_t fileSize, const std::string& path);
+// maps the file copy-on-write and returns a grid viewing it, so changes never reach the file.
+// verify recomputes the checksum, which means touching every page
+bool mapLevel(const std::string& path, MazeGrid& grid, LevelHeader& header, bool verify);
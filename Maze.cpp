@@ -1,57 +1,121 @@
 #include "Maze.h"
+#include "UnionFind.h"
+#include "Eller.h"
+#include "ThreadPool.h"
+#include "LevelFile.h"
+#include <utility>      // std::swap
 #include <algorithm>
-#include <random>       // std::default_random_engine
 #include <chrono>       // std::chrono::system_clock
 #include <iostream>
+#include <cstdint>
+#include <string>
+#if defined(__BMI2__)
+#include <immintrin.h>  // _pdep_u64
+#endif
 
-Maze::Maze(int size)
+// cells per side of a tile in the tiled generator. a multiple of 32 so that no two
+// tiles ever write to the same 64-bit word of a grid row
+const int TILE_CELLS = 64;
+
+// share of cells aldous-broder adds to the tree before wilson's algorithm takes over
+const double WILSON_HEAD_START = 1.0 / 3.0;
+
+// rooms with at least this many cells are divided on the thread pool, smaller ones serially
+const int DIVISION_CUTOFF = 64 * 64;
+
+Maze::Maze() : size(0), gen(dfsIterative), seed(0), rng(0)
+{
+}
+
+Maze::Maze(int size, generator gen, uint64_t seed, unsigned threads) : size(size), gen(gen), seed(seed), rng(seed)
 {
-	// true is cell, false wall
-	this->size = size;
-	data = std::vector<std::vector<bool>>(size, std::vector<bool>(size, false));
-	data[1][1] = 1;
+	// open bit is cell, clear bit wall. below 3 there is no room for a cell, it stays all wall
+	data = MazeGrid(std::max(size, 0), std::max(size, 0));
+	if (size < 3)
+	{
+		return;
+	}
+	data.setOpen(1, 1);
 
-	recurse(1, 1);
+	switch (gen)
+	{
+	case dfsRecursive:
+		recurse(1, 1);
+		break;
+	case dfsIterative:
+		carve(1, 1, 1, 1, size - 2, size - 2, rng);
+		break;
+	case kruskal:
+		joinRandomEdges();
+		break;
+	case eller:
+		if (size >= 3)
+		{
+			EllerGenerator rows((size - 1) / 2, seed);
+			int count = rows.wordsPerRow();
+			rows.generate((size - 1) / 2, [this, count](int row, const uint64_t* words)
+			{
+				std::copy(words, words + count, data.row(row));
+			});
+		}
+		break;
+	case tiled:
+		generateTiles(threads);
+		break;
+	case binaryTree:
+		generateRows(false, threads);
+		break;
+	case sidewinder:
+		generateRows(true, threads);
+		break;
+	case division:
+		generateDivision(threads);
+		break;
+	case wilson:
+		generateWilson();
+		break;
+	}
 }
 
 void Maze::recurse(int row, int col)
 {
-	std::vector<int> order = randOrder();
-	for (int i : order)
+	direction order[4];
+	shuffleDirections(order);
+	for (direction d : order)
 	{
 		// stops when no free cells. first check space in map, then if 2 slots over is a cell or wall
-		switch (static_cast<direction>(i))
+		switch (d)
 		{
 		case north:
 
-			if (row - 2 > 0 && !data[row - 2][col]) // not yet cell, make cell
+			if (row - 2 > 0 && data.isWall(row - 2, col)) // not yet cell, make cell
 			{
-				data[row - 1][col] = 1;
-				data[row - 2][col] = 1;
+				data.setOpen(row - 1, col);
+				data.setOpen(row - 2, col);
 				recurse(row - 2, col);
 			}
 			break;
 		case east:
-			if (col + 2 < size - 1 && !data[row][col + 2])
+			if (col + 2 < size - 1 && data.isWall(row, col + 2))
 			{
-				data[row][col + 1] = 1;
-				data[row][col + 2] = 1;
+				data.setOpen(row, col + 1);
+				data.setOpen(row, col + 2);
 				recurse(row, col + 2);
 			}
 			break;
 		case south:
-			if (row + 2 < size - 1 && !data[row + 2][col])
+			if (row + 2 < size - 1 && data.isWall(row + 2, col))
 			{
-				data[row + 1][col] = 1;
-				data[row + 2][col] = 1;
+				data.setOpen(row + 1, col);
+				data.setOpen(row + 2, col);
 				recurse(row + 2, col);
 			}
 			break;
 		case west:
-			if (col - 2 > 2 && !data[row][col - 2])
+			if (col - 2 > 0 && data.isWall(row, col - 2))
 			{
-				data[row][col - 1] = 1;
-				data[row][col - 2] = 1;
+				data.setOpen(row, col - 1);
+				data.setOpen(row, col - 2);
 				recurse(row, col - 2);
 			}
 			break;
@@ -59,27 +123,520 @@ void Maze::recurse(int row, int col)
 	}
 }
 
-std::vector<int> Maze::randOrder()
+void Maze::carve(int row, int col, int top, int left, int bottom, int right, Rng& rng)
+{
+	// same depth first search as recurse, but the path back is kept on a heap allocated
+	// stack of packed cell indices, so maze size is no longer limited by the call stack.
+	// only cells inside rows top..bottom and columns left..right are carved
+	std::vector<uint32_t> stack;
+	stack.push_back(static_cast<uint32_t>(row) * size + col);
+	while (!stack.empty())
+	{
+		row = stack.back() / size;
+		col = stack.back() % size;
+		// carve towards a random free neighbour, backtrack if there is none
+		direction free[4];
+		int count = 0;
+		if (row - 2 >= top && data.isWall(row - 2, col))
+		{
+			free[count++] = north;
+		}
+		if (col + 2 <= right && data.isWall(row, col + 2))
+		{
+			free[count++] = east;
+		}
+		if (row + 2 <= bottom && data.isWall(row + 2, col))
+		{
+			free[count++] = south;
+		}
+		if (col - 2 >= left && data.isWall(row, col - 2))
+		{
+			free[count++] = west;
+		}
+		if (count == 0)
+		{
+			stack.pop_back();
+			continue;
+		}
+		int dRow = 0, dCol = 0;
+		switch (free[rng.below(count)])
+		{
+		case north: dRow = -1; break;
+		case east: dCol = 1; break;
+		case south: dRow = 1; break;
+		case west: dCol = -1; break;
+		}
+		data.setOpen(row + dRow, col + dCol);
+		data.setOpen(row + 2 * dRow, col + 2 * dCol);
+		stack.push_back(static_cast<uint32_t>(row + 2 * dRow) * size + col + 2 * dCol);
+	}
+}
+
+void Maze::joinRandomEdges()
+{
+	// kruskal: visit every internal wall once in random order and knock it down
+	// if the cells on either side are not yet connected
+	uint32_t n = (size - 1) / 2; // cells per side
+	if (n == 0)
+	{
+		return;
+	}
+	for (uint32_t i = 0; i < n; i++)
+	{
+		for (uint32_t j = 0; j < n; j++)
+		{
+			data.setOpen(2 * i + 1, 2 * j + 1);
+		}
+	}
+	// edge is cell * 2, +0 for the wall east of it and +1 for the wall south of it
+	std::vector<uint32_t> edges;
+	edges.reserve(2 * n * (n - 1));
+	for (uint32_t cell = 0; cell < n * n; cell++)
+	{
+		if (cell % n + 1 < n)
+		{
+			edges.push_back(cell * 2);
+		}
+		if (cell / n + 1 < n)
+		{
+			edges.push_back(cell * 2 + 1);
+		}
+	}
+	for (size_t i = edges.size(); i > 1; i--)
+	{
+		std::swap(edges[i - 1], edges[rng.below(i)]);
+	}
+	UnionFind sets(n * n);
+	uint32_t joins = 0;
+	for (size_t i = 0; i < edges.size() && joins + 1 < n * n; i++)
+	{
+		uint32_t cell = edges[i] / 2;
+		bool southWall = edges[i] & 1;
+		if (sets.unite(cell, southWall ? cell + n : cell + 1))
+		{
+			int row = 2 * (cell / n) + 1;
+			int col = 2 * (cell % n) + 1;
+			data.setOpen(southWall ? row + 1 : row, southWall ? col : col + 1);
+			joins++;
+		}
+	}
+}
+
+void Maze::generateTiles(unsigned threads)
+{
+	// every tile gets its own perfect maze from a seed derived from its index, so the
+	// result does not depend on which thread carves which tile
+	int n = (size - 1) / 2; // cells per side
+	if (n == 0)
+	{
+		return;
+	}
+	int tiles = (n + TILE_CELLS - 1) / TILE_CELLS;
+	ThreadPool pool(threads);
+	pool.parallelFor((size_t)tiles * tiles, [this, n, tiles](size_t tile)
+	{
+		int firstRow = tile / tiles * TILE_CELLS;
+		int firstCol = tile % tiles * TILE_CELLS;
+		int lastRow = std::min(firstRow + TILE_CELLS, n) - 1;
+		int lastCol = std::min(firstCol + TILE_CELLS, n) - 1;
+		Rng tileRng(mixSeed(seed, tile));
+		data.setOpen(2 * firstRow + 1, 2 * firstCol + 1);
+		carve(2 * firstRow + 1, 2 * firstCol + 1, 2 * firstRow + 1, 2 * firstCol + 1, 2 * lastRow + 1, 2 * lastCol + 1, tileRng);
+	});
+	// stitch the tiles along a random spanning tree of the tile grid, one opening per
+	// tree edge, which keeps the whole maze a single tree
+	std::vector<uint32_t> edges;
+	for (uint32_t tile = 0; tile < (uint32_t)(tiles * tiles); tile++)
+	{
+		if (tile % tiles + 1 < (uint32_t)tiles)
+		{
+			edges.push_back(tile * 2);
+		}
+		if (tile / tiles + 1 < (uint32_t)tiles)
+		{
+			edges.push_back(tile * 2 + 1);
+		}
+	}
+	for (size_t i = edges.size(); i > 1; i--)
+	{
+		std::swap(edges[i - 1], edges[rng.below(i)]);
+	}
+	UnionFind sets(tiles * tiles);
+	for (uint32_t edge : edges)
+	{
+		uint32_t tile = edge / 2;
+		bool southBorder = edge & 1;
+		if (!sets.unite(tile, southBorder ? tile + tiles : tile + 1))
+		{
+			continue;
+		}
+		int firstRow = tile / tiles * TILE_CELLS;
+		int firstCol = tile % tiles * TILE_CELLS;
+		if (southBorder)
+		{
+			int span = std::min(firstCol + TILE_CELLS, n) - firstCol;
+			data.setOpen(2 * (firstRow + TILE_CELLS), 2 * (firstCol + (int)rng.below(span)) + 1);
+		}
+		else
+		{
+			int span = std::min(firstRow + TILE_CELLS, n) - firstRow;
+			data.setOpen(2 * (firstRow + (int)rng.below(span)) + 1, 2 * (firstCol + TILE_CELLS));
+		}
+	}
+}
+
+// moves bit i of x to bit 2i, turning 32 cells into the 64 grid columns they span
+static inline uint64_t spreadBits(uint32_t x)
+{
+#if defined(__BMI2__)
+	return _pdep_u64(x, 0x5555555555555555ull);
+#else
+	uint64_t v = x;
+	v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+	v = (v | (v << 8)) & 0x00ff00ff00ff00ffull;
+	v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0full;
+	v = (v | (v << 2)) & 0x3333333333333333ull;
+	v = (v | (v << 1)) & 0x5555555555555555ull;
+	return v;
+#endif
+}
+
+void Maze::generateRows(bool sidewinderRuns, unsigned threads)
+{
+	// binary tree and sidewinder only ever carve east or north, so every row of cells
+	// is decided on its own: 64 cells per random word, rows spread over the threads.
+	// each row draws from an Rng seeded with its index, so thread count does not matter
+	int n = (size - 1) / 2; // cells per side
+	if (n == 0)
+	{
+		return;
+	}
+	int cellWords = (n + 63) / 64;
+	int gridWords = (2 * n + 1 + 63) / 64;
+	const int ROWS_PER_TASK = 64;
+	ThreadPool pool(threads);
+	pool.parallelFor((n + ROWS_PER_TASK - 1) / ROWS_PER_TASK, [=](size_t task)
+	{
+		// one bit per cell: cell exists, carves east, carves north
+		std::vector<uint64_t> cells(cellWords), eastBits(cellWords), northBits(cellWords);
+		int lastRow = std::min((int)task * ROWS_PER_TASK + ROWS_PER_TASK, n);
+		for (int r = task * ROWS_PER_TASK; r < lastRow; r++)
+		{
+			Rng rowRng(mixSeed(seed, r));
+			for (int k = 0; k < cellWords; k++)
+			{
+				int inWord = std::min(64, n - 64 * k);
+				cells[k] = inWord == 64 ? ~uint64_t(0) : (uint64_t(1) << inWord) - 1;
+				// the last cell has nothing east of it
+				uint64_t canEast = k == cellWords - 1 ? cells[k] >> 1 : cells[k];
+				eastBits[k] = r == 0 ? canEast : rowRng.next() & canEast;
+				northBits[k] = 0;
+				if (r > 0 && !sidewinderRuns)
+				{
+					northBits[k] = cells[k] & ~eastBits[k];
+				}
+			}
+			if (r > 0 && sidewinderRuns)
+			{
+				// a run ends at every cell that does not carve east, one random cell
+				// of each run carves north
+				int runStart = 0;
+				for (int k = 0; k < cellWords; k++)
+				{
+					uint64_t ends = cells[k] & ~eastBits[k];
+					while (ends)
+					{
+						int end = 64 * k + __builtin_ctzll(ends);
+						int pick = runStart + rowRng.below(end - runStart + 1);
+						northBits[pick >> 6] |= uint64_t(1) << (pick & 63);
+						runStart = end + 1;
+						ends &= ends - 1;
+					}
+				}
+			}
+			// expand into grid rows: cell j sits at column 2j + 1, its east passage at 2j + 2
+			uint64_t* cellRow = data.row(2 * r + 1);
+			uint64_t* northRow = data.row(2 * r);
+			for (int g = 0; g < gridWords; g++)
+			{
+				// the last grid word may hold only the outer wall, past every cell word
+				int shift = 32 * (g & 1);
+				bool inCells = (g >> 1) < cellWords;
+				uint32_t c = inCells ? cells[g >> 1] >> shift : 0;
+				uint32_t e = inCells ? eastBits[g >> 1] >> shift : 0;
+				uint32_t up = inCells ? northBits[g >> 1] >> shift : 0;
+				uint64_t word = spreadBits(c) << 1 | spreadBits(e) << 2;
+				if (g > 0)
+				{
+					// east passage of the last cell of the previous word
+					int prev = 32 * g - 1;
+					word |= (eastBits[prev >> 6] >> (prev & 63)) & 1;
+				}
+				cellRow[g] = word;
+				northRow[g] = spreadBits(up) << 1;
+			}
+		}
+	});
+}
+
+void Maze::generateDivision(unsigned threads)
 {
-	// gives random ordering of cardinal directions n...w => 0...3
-	std::vector<int> out = std::vector<int>();
+	// recursive division: start from one open room and keep splitting rooms with a wall
+	// that has a single gap, until every room is one cell wide or tall
+	int n = (size - 1) / 2; // cells per side
+	if (n == 0)
+	{
+		return;
+	}
+	for (int row = 1; row < 2 * n; row++)
+	{
+		for (int col = 1; col < 2 * n; col++)
+		{
+			data.setOpen(row, col);
+		}
+	}
+	ThreadPool pool(threads);
+	pool.submit([this, n, &pool] { divide(0, 0, n, n, seed, pool); });
+	pool.wait();
+}
+
+void Maze::divide(int top, int left, int height, int width, uint64_t seed, ThreadPool& pool)
+{
+	// rooms are in cells. the two halves of a split only go to separate tasks when they
+	// cannot share a grid word: a horizontal wall always, a vertical one only on a
+	// column that is a multiple of 32 cells. the random draws inside a task only depend
+	// on its seed, so the maze is the same for any number of threads
+	struct Room { int top, left, height, width; };
+	Rng rng(seed);
+	std::vector<Room> rooms{{top, left, height, width}};
+	while (!rooms.empty())
+	{
+		Room room = rooms.back();
+		rooms.pop_back();
+		if (room.height < 2 || room.width < 2)
+		{
+			continue;
+		}
+		bool large = room.height * room.width >= DIVISION_CUTOFF;
+		bool horizontal = room.height > room.width || (room.height == room.width && (rng.next() & 1));
+		bool parallel = large;
+		Room first = room, second = room;
+		if (horizontal)
+		{
+			int k = 1 + rng.below(room.height - 1);
+			int wallRow = 2 * (room.top + k);
+			for (int col = 2 * room.left + 1; col < 2 * (room.left + room.width); col++)
+			{
+				data.setWall(wallRow, col);
+			}
+			data.setOpen(wallRow, 2 * (room.left + rng.below(room.width)) + 1);
+			first.height = k;
+			second.top += k;
+			second.height -= k;
+		}
+		else
+		{
+			// multiples of 32 strictly inside the room
+			int firstAligned = (room.left / 32 + 1) * 32;
+			int aligned = firstAligned < room.left + room.width ? (room.left + room.width - 1 - firstAligned) / 32 + 1 : 0;
+			int k;
+			if (large && aligned > 0)
+			{
+				k = firstAligned + 32 * rng.below(aligned) - room.left;
+			}
+			else
+			{
+				k = 1 + rng.below(room.width - 1);
+				parallel = false;
+			}
+			int wallCol = 2 * (room.left + k);
+			for (int row = 2 * room.top + 1; row < 2 * (room.top + room.height); row++)
+			{
+				data.setWall(row, wallCol);
+			}
+			data.setOpen(2 * (room.top + rng.below(room.height)) + 1, wallCol);
+			first.width = k;
+			second.left += k;
+			second.width -= k;
+		}
+		if (parallel)
+		{
+			uint64_t childSeed = rng.next();
+			pool.submit([this, second, childSeed, &pool] { divide(second.top, second.left, second.height, second.width, childSeed, pool); });
+		}
+		else
+		{
+			rooms.push_back(second);
+		}
+		rooms.push_back(first);
+	}
+}
+
+void Maze::generateWilson()
+{
+	// wilson's algorithm: loop-erased random walks from every cell outside the tree until
+	// they hit it. its first walks wander for a long time looking for a tiny tree, so the
+	// tree is first grown by an aldous-broder walk, which is quick while most cells are new.
+	// a cell is in the tree once it is open in the grid
+	int n = (size - 1) / 2; // cells per side
+	if (n == 0)
+	{
+		return;
+	}
+	uint32_t cells = (uint32_t)n * n;
+	uint64_t randomBits = 0;
+	int bitsLeft = 0;
+	// random direction that stays inside the maze
+	auto step = [&](uint32_t cell)
+	{
+		int row = cell / n, col = cell % n;
+		while (true)
+		{
+			if (bitsLeft == 0)
+			{
+				randomBits = rng.next();
+				bitsLeft = 32;
+			}
+			int d = randomBits & 3;
+			randomBits >>= 2;
+			bitsLeft--;
+			int r = row + DIRECTION_ROWS[d], c = col + DIRECTION_COLS[d];
+			if (r >= 0 && r < n && c >= 0 && c < n)
+			{
+				return d;
+			}
+		}
+	};
+	auto inTree = [&](uint32_t cell)
+	{
+		return data.isOpen(2 * (cell / n) + 1, 2 * (cell % n) + 1);
+	};
+	// opens cell and the passage leaving it in direction d
+	auto join = [&](uint32_t cell, int d)
+	{
+		int row = 2 * (cell / n) + 1, col = 2 * (cell % n) + 1;
+		data.setOpen(row, col);
+		data.setOpen(row + DIRECTION_ROWS[d], col + DIRECTION_COLS[d]);
+	};
+	auto neighbour = [&](uint32_t cell, int d)
+	{
+		return (uint32_t)((int)cell + DIRECTION_ROWS[d] * n + DIRECTION_COLS[d]);
+	};
+
+	// the tree starts from the top left cell the constructor opened
+	uint32_t current = 0;
+	uint32_t inTreeCount = 1;
+	while (inTreeCount < cells * WILSON_HEAD_START)
+	{
+		int d = step(current);
+		uint32_t next = neighbour(current, d);
+		if (!inTree(next))
+		{
+			join(next, (d + 2) % 4);
+			inTreeCount++;
+		}
+		current = next;
+	}
+
+	// last direction taken from each cell in the current walk, overwriting it erases loops
+	std::vector<uint8_t> exit(cells);
+	for (uint32_t start = 0; start < cells; start++)
+	{
+		if (inTree(start))
+		{
+			continue;
+		}
+		for (current = start; !inTree(current); current = neighbour(current, exit[current]))
+		{
+			exit[current] = step(current);
+		}
+		for (current = start; !inTree(current); current = neighbour(current, exit[current]))
+		{
+			join(current, exit[current]);
+		}
+	}
+}
+
+void Maze::shuffleDirections(direction order[4])
+{
+	// fisher-yates over the four cardinal directions, no allocation
 	for (int i = 0; i < 4; i++)
 	{
-		out.push_back(i);
+		order[i] = static_cast<direction>(i);
+	}
+	for (int i = 3; i > 0; i--)
+	{
+		std::swap(order[i], order[rng.below(i + 1)]);
+	}
+}
+
+bool Maze::save(const std::string& path) const
+{
+	return writeLevel(path, data, seed, gen);
+}
+
+bool Maze::load(const std::string& path, bool verify)
+{
+	LevelHeader header;
+	MazeGrid grid;
+	if (!mapLevel(path, grid, header, verify))
+	{
+		return false;
+	}
+	if (header.rows != header.cols)
+	{
+		std::cout << "Level is not square: " << path << std::endl;
+		return false;
+	}
+	data = std::move(grid);
+	size = header.rows;
+	gen = static_cast<generator>(header.generatorId);
+	seed = header.seed;
+	rng = Rng(seed);
+	return true;
+}
+
+// in generator order
+const char* GENERATOR_NAMES[] = {"dfsRecursive", "dfsIterative", "kruskal", "eller", "tiled", "binaryTree", "sidewinder", "division", "wilson"};
+static_assert(sizeof(GENERATOR_NAMES) / sizeof(GENERATOR_NAMES[0]) == GENERATOR_COUNT, "every generator needs a name and GENERATOR_COUNT");
+
+const char* generatorName(generator gen)
+{
+	if ((uint32_t)gen >= GENERATOR_COUNT)
+	{
+		return "unknown";
 	}
-	unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-	std::shuffle(out.begin(), out.end(), std::default_random_engine(seed));
-	return out;
+	return GENERATOR_NAMES[gen];
+}
+
+bool generatorFromName(const std::string& name, generator& gen)
+{
+	for (uint32_t i = 0; i < GENERATOR_COUNT; i++)
+	{
+		if (name == GENERATOR_NAMES[i])
+		{
+			gen = static_cast<generator>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+uint64_t clockSeed()
+{
+	return std::chrono::system_clock::now().time_since_epoch().count();
 }
 
 void Maze::print()
 {
+	std::string line(size, 'x');
 	for (int i = 0; i < size; i++)
 	{
+		const uint64_t* words = data.row(i);
 		for (int j = 0; j < size; j++)
 		{
-			std::cout << (data[i][j] ? " " : "x");
+			line[j] = (words[j >> 6] >> (j & 63)) & 1 ? ' ' : 'x';
 		}
-		std::cout << "\n";
+		std::cout << line << "\n";
 	}
 }
@@ -1,16 +1,63 @@
 #pragma once
 #include <vector>
+#include <cstdint>
+#include <string>
+#include "MazeGrid.h"
+#include "Rng.h"
+
+class ThreadPool;
 
 enum direction {north, east, south, west};
+// grid steps towards each direction
+const int DIRECTION_ROWS[] = {-1, 0, 1, 0};
+const int DIRECTION_COLS[] = {0, 1, 0, -1};
+// maze generation algorithms, selectable from the constructor. the values are stored in
+// level files, so new ones go at the end
+enum generator {dfsRecursive, dfsIterative, kruskal, eller, tiled, binaryTree, sidewinder, division, wilson};
+// one past the last generator, Maze.cpp checks it against the generator names
+const uint32_t GENERATOR_COUNT = wilson + 1;
+// tiled carves 64x64 cell tiles in parallel and joins them along a random spanning tree
+
+// "unknown" for a value past the last generator
+const char* generatorName(generator gen);
+// false if name is not one of the generatorName values
+bool generatorFromName(const std::string& name, generator& gen);
+
+// seed taken from the system clock, for when no explicit seed is given
+uint64_t clockSeed();
 
 class Maze
 {
 private:
 	int size;
+	generator gen;
+	uint64_t seed;
+	Rng rng;
 	void recurse(int row, int col);
-	std::vector<int> randOrder();
+	void carve(int row, int col, int top, int left, int bottom, int right, Rng& rng);
+	void joinRandomEdges();
+	void generateTiles(unsigned threads);
+	void generateRows(bool sidewinderRuns, unsigned threads);
+	void generateDivision(unsigned threads);
+	void generateWilson();
+	void divide(int top, int left, int height, int width, uint64_t seed, ThreadPool& pool);
+	void shuffleDirections(direction order[4]);
 public:
-	std::vector<std::vector<bool>> data;
-	Maze(int size);
+	MazeGrid data;
+	// threads is only used by the parallel generators, 0 means one per hardware thread
+	Maze(int size, generator gen = dfsIterative, uint64_t seed = clockSeed(), unsigned threads = 0);
+	// empty maze, for load
+	Maze();
+	uint64_t getSeed() const { return seed; }
+	generator getGenerator() const { return gen; }
+	// bounds checked wall test, nothing outside the grid counts as a wall
+	bool isWall(int64_t row, int64_t col) const
+	{
+		return BoundedGrid<MazeGrid>{data}.isWall(row, col);
+	}
 	void print();
+	// binary level file, see LevelFile.h. load maps the file instead of reading it, so large
+	// levels are ready at once; verify checks the payload checksum first
+	bool save(const std::string& path) const;
+	bool load(const std::string& path, bool verify = true);
 };
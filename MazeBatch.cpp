@@ -0,0 +1,30 @@
+#include "MazeBatch.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
+std::string batchPath(const std::string& outDir, uint64_t seed)
+{
+	return (std::filesystem::path(outDir) / ("maze_" + std::to_string(seed) + ".glmz")).string();
+}
+
+BatchStats generateBatch(int count, uint64_t firstSeed, int size, generator gen, const std::string& outDir, unsigned threads)
+{
+	std::error_code ignored;
+	std::filesystem::create_directories(outDir, ignored);
+	std::atomic<size_t> written(0), failed(0);
+	auto start = std::chrono::steady_clock::now();
+	ThreadPool pool(threads);
+	pool.parallelFor(count, [&](size_t i)
+	{
+		// the parallel generators get one thread each, the batch is already spread out
+		Maze m(size, gen, firstSeed + i, 1);
+		if (m.save(batchPath(outDir, firstSeed + i)))
+			written++;
+		else
+			failed++;
+	});
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return BatchStats{written, failed, elapsed.count()};
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Maze.h"
+
+struct BatchStats
+{
+	size_t written;
+	size_t failed;
+	double seconds;
+};
+
+// generates count mazes with seeds firstSeed, firstSeed + 1, ... across a thread pool and
+// writes each to outDir/maze_<seed>.glmz. every maze draws from its own seed, so the files
+// are the same whatever the number of threads
+BatchStats generateBatch(int count, uint64_t firstSeed, int size, generator gen, const std::string& outDir, unsigned threads = 0);
+std::string batchPath(const std::string& outDir, uint64_t seed);
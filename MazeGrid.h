@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// maze cells packed one bit per cell into a single row-major array of 64-bit words.
+// a set bit is an open cell and a clear bit a wall, so a fresh grid is all wall.
+// column c of a row lives at bit c % 64 of word c / 64; bits past the last column stay clear.
+// the words are either owned or a view into memory kept alive by a mapping (see LevelFile.h);
+// copies always own their words
+class MazeGrid
+{
+private:
+	int nRows;
+	int nCols;
+	int stride; // words per row
+	std::vector<uint64_t> owned;
+	uint64_t* bits;
+	std::shared_ptr<void> mapping;
+public:
+	MazeGrid() : nRows(0), nCols(0), stride(0), bits(nullptr) {}
+	MazeGrid(int rows, int cols) : nRows(rows), nCols(cols), stride((cols + 63) / 64), owned((size_t)stride * rows, 0), bits(owned.data()) {}
+	// view over rows * ((cols + 63) / 64) words owned by mapping
+	MazeGrid(int rows, int cols, uint64_t* words, std::shared_ptr<void> mapping) : nRows(rows), nCols(cols), stride((cols + 63) / 64), bits(words), mapping(std::move(mapping)) {}
+	MazeGrid(const MazeGrid& other) : nRows(other.nRows), nCols(other.nCols), stride(other.stride), owned(other.bits, other.bits + other.wordCount()), bits(owned.data()) {}
+	MazeGrid(MazeGrid&& other) noexcept : MazeGrid()
+	{
+		swap(other);
+	}
+	MazeGrid& operator=(MazeGrid other)
+	{
+		swap(other);
+		return *this;
+	}
+	void swap(MazeGrid& other) noexcept
+	{
+		std::swap(nRows, other.nRows);
+		std::swap(nCols, other.nCols);
+		std::swap(stride, other.stride);
+		owned.swap(other.owned);
+		std::swap(bits, other.bits);
+		mapping.swap(other.mapping);
+	}
+
+	int rows() const { return nRows; }
+	int cols() const { return nCols; }
+	int wordsPerRow() const { return stride; }
+	size_t wordCount() const { return (size_t)stride * nRows; }
+	bool isMapped() const { return mapping != nullptr; }
+
+	bool isWall(int row, int col) const
+	{
+		return !((bits[(size_t)row * stride + (col >> 6)] >> (col & 63)) & 1);
+	}
+	bool isOpen(int row, int col) const
+	{
+		return !isWall(row, col);
+	}
+	void setOpen(int row, int col)
+	{
+		bits[(size_t)row * stride + (col >> 6)] |= uint64_t(1) << (col & 63);
+	}
+	void setWall(int row, int col)
+	{
+		bits[(size_t)row * stride + (col >> 6)] &= ~(uint64_t(1) << (col & 63));
+	}
+
+	// whole row as wordsPerRow() words
+	const uint64_t* row(int row) const { return bits + (size_t)row * stride; }
+	uint64_t* row(int row) { return bits + (size_t)row * stride; }
+	// all rows back to back, rows() * wordsPerRow() words
+	const uint64_t* words() const { return bits; }
+	uint64_t* words() { return bits; }
+};
+
+// bounds checked wall test over any grid with the MazeGrid read interface (MazeGrid, PagedGrid),
+// for callers such as Camera collision that look around a position without knowing the size
+template <class Grid>
+struct BoundedGrid
+{
+	const Grid& grid;
+	bool isWall(int64_t row, int64_t col) const
+	{
+		return row >= 0 && col >= 0 && row < grid.rows() && col < grid.cols() && grid.isWall(row, col);
+	}
+};
+
+// mazes lay their cells out at the odd rows and columns of the grid, cell r, c at grid
+// position (2r + 1, 2c + 1) with the passages and posts between them. the solvers and
+// pathfinders working on cells (MazeSolver, CorridorGraph, FlowField, HierarchicalPathfinder,
+// KeyDoorPuzzle) take and return grid positions, where a passage or post counts as the cell
+// above and left of it and positions off the maze as the nearest cell. the ones keeping
+// search scratch space inside (CorridorGraph, HierarchicalPathfinder, KeyDoorPuzzle) must
+// not be queried from several threads at once.
+// cells along a side of gridSize positions; an even size leaves a spare wall row or column
+inline int cellsAlong(int gridSize)
+{
+	return gridSize > 1 ? (gridSize - 1) / 2 : 0;
+}
+// the cell along a side of cells cells that grid position gridPos belongs to
+inline int cellAt(int gridPos, int cells)
+{
+	return std::min(std::max((gridPos - 1) / 2, 0), cells - 1);
+}
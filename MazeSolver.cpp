@@ -0,0 +1,271 @@
+#include "MazeSolver.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <memory>
+#if defined(__BMI2__)
+#include <immintrin.h>  // _pext_u64
+#endif
+
+// frontier tiles in a BFS level before it is expanded on the thread pool
+const size_t PARALLEL_FRONTIER_TILES = 4096;
+
+// columns and rows of a tile word, bit (row % 8) * 8 + col % 8
+const uint64_t TILE_COL0 = 0x0101010101010101ull;
+const uint64_t TILE_COL7 = TILE_COL0 << 7;
+const uint64_t TILE_ROW0 = 0xffull;
+const uint64_t TILE_ROW7 = TILE_ROW0 << 56;
+
+// the odd bits of x packed into the low 32 bits
+static inline uint64_t oddBits(uint64_t x)
+{
+#if defined(__BMI2__)
+	return _pext_u64(x, 0xaaaaaaaaaaaaaaaaull);
+#else
+	x = (x >> 1) & 0x5555555555555555ull;
+	x = (x | (x >> 1)) & 0x3333333333333333ull;
+	x = (x | (x >> 2)) & 0x0f0f0f0f0f0f0f0full;
+	x = (x | (x >> 4)) & 0x00ff00ff00ff00ffull;
+	x = (x | (x >> 8)) & 0x0000ffff0000ffffull;
+	x = (x | (x >> 16)) & 0x00000000ffffffffull;
+	return x;
+#endif
+}
+
+MazeSolver::MazeSolver(const MazeGrid& grid, int targetRow, int targetCol, unsigned threads) : nCellRows(cellsAlong(grid.rows())),
+	nCellCols(cellsAlong(grid.cols())), tilesPerRow((nCellCols + 7) / 8), targetCell{0, 0}, farCell{0, 0}, levels(0)
+{
+	if (nCellRows == 0 || nCellCols == 0)
+	{
+		return;
+	}
+	targetCell[0] = cellAt(targetRow, nCellRows);
+	targetCell[1] = cellAt(targetCol, nCellCols);
+	readPassages(grid);
+	search(threads);
+}
+
+void MazeSolver::readPassages(const MazeGrid& grid)
+{
+	// cell c of a row is grid column 2c + 1 and its east passage column 2c + 2, so both
+	// planes are the odd bits of a grid row, the east one shifted down a column first.
+	// passages out of the last row and column are left closed. a row of 64 cells then
+	// gives one byte to each of eight tiles
+	tiles.assign((size_t)tilesPerRow * ((nCellRows + 7) / 8), Tile{0, 0, 0, 0, 0});
+	int gridWords = grid.wordsPerRow();
+	int cellWords = (nCellCols + 63) / 64;
+	for (int r = 0; r < nCellRows; r++)
+	{
+		const uint64_t* cells = grid.row(2 * r + 1);
+		const uint64_t* below = grid.row(2 * r + 2);
+		Tile* tileRow = &tiles[(size_t)(r >> 3) * tilesPerRow];
+		int shift = (r & 7) << 3;
+		for (int w = 0; w < cellWords; w++)
+		{
+			uint64_t east = 0, south = 0;
+			for (int half = 0; half < 2 && 2 * w + half < gridWords; half++)
+			{
+				int g = 2 * w + half;
+				uint64_t next = g + 1 < gridWords ? cells[g + 1] : 0;
+				east |= oddBits(cells[g] >> 1 | next << 63) << (32 * half);
+				south |= oddBits(below[g]) << (32 * half);
+			}
+			int inWord = std::min(64, nCellCols - 64 * w);
+			uint64_t valid = inWord == 64 ? ~0ull : (1ull << inWord) - 1;
+			if (w == cellWords - 1)
+			{
+				east &= valid >> 1;
+			}
+			east &= valid;
+			south = r + 1 < nCellRows ? south & valid : 0;
+			for (int t = 8 * w; t < std::min(8 * w + 8, tilesPerRow); t++)
+			{
+				tileRow[t].east |= ((east >> ((t & 7) << 3)) & 0xff) << shift;
+				tileRow[t].south |= ((south >> ((t & 7) << 3)) & 0xff) << shift;
+			}
+		}
+	}
+}
+
+template <class Emit>
+void MazeSolver::expand(const FrontierWord& from, Emit&& emit) const
+{
+	// every neighbour of the frontier bits that a passage leads to, still to be masked by
+	// visited: first the ones inside the tile, then across each of its four sides
+	uint32_t t = from.tile;
+	uint64_t f = from.bits;
+	const Tile& tile = tiles[t];
+	uint64_t east = f & tile.east;
+	uint64_t south = f & tile.south;
+	emit(t, (east & ~TILE_COL7) << 1 | ((f & ~TILE_COL0) >> 1 & tile.east)
+		| (south & ~TILE_ROW7) << 8 | ((f & ~TILE_ROW0) >> 8 & tile.south));
+	if (east & TILE_COL7)
+	{
+		emit(t + 1, (east & TILE_COL7) >> 7);
+	}
+	if (south & TILE_ROW7)
+	{
+		emit(t + tilesPerRow, south >> 56);
+	}
+	// the tile before the first of a row is the last of the row above, whose east passages
+	// out of column 7 are all closed, so no row check is needed
+	if ((f & TILE_COL0) && t > 0)
+	{
+		emit(t - 1, (f & TILE_COL0) << 7 & tiles[t - 1].east);
+	}
+	if ((f & TILE_ROW0) && t >= (uint32_t)tilesPerRow)
+	{
+		emit(t - tilesPerRow, (f & TILE_ROW0) << 56 & tiles[t - tilesPerRow].south);
+	}
+}
+
+void MazeSolver::search(unsigned threads)
+{
+	dist.assign(tiles.size() * 64, UNREACHED);
+	std::vector<FrontierWord> frontier, next;
+	std::unique_ptr<ThreadPool> pool;
+	std::vector<std::vector<FrontierWord>> found;
+
+	size_t start = cellIndex(targetCell[0], targetCell[1]);
+	tiles[start / 64].visited = 1ull << (start % 64);
+	dist[start] = 0;
+	frontier.push_back(FrontierWord{(uint32_t)(start / 64), 1ull << (start % 64)});
+	FrontierWord last = frontier[0];
+
+	for (uint32_t level = 1; !frontier.empty(); level++)
+	{
+		next.clear();
+		auto merge = [&](uint32_t t, uint64_t bits)
+		{
+			// newly reached cells are marked and given their distance straight away, cells
+			// still to be expanded this level are already visited so nothing is lost
+			if (!bits)
+			{
+				return;
+			}
+			Tile& tile = tiles[t];
+			bits &= ~tile.visited;
+			if (!bits)
+			{
+				return;
+			}
+			tile.visited |= bits;
+			uint32_t* tileDist = &dist[(size_t)t * 64];
+			for (uint64_t b = bits; b; b &= b - 1)
+			{
+				tileDist[__builtin_ctzll(b)] = level;
+			}
+			if (tile.stamp == level)
+			{
+				next[tile.slot].bits |= bits;
+				return;
+			}
+			tile.stamp = level;
+			tile.slot = next.size();
+			next.push_back(FrontierWord{t, bits});
+		};
+		if (frontier.size() >= PARALLEL_FRONTIER_TILES && threads != 1)
+		{
+			// each task expands a slice of the frontier on its own, then the slices are merged
+			if (!pool)
+			{
+				pool.reset(new ThreadPool(threads));
+				found.resize(pool->size());
+			}
+			size_t slices = found.size();
+			pool->parallelFor(slices, [&](size_t s)
+			{
+				found[s].clear();
+				size_t end = (s + 1) * frontier.size() / slices;
+				for (size_t i = s * frontier.size() / slices; i < end; i++)
+				{
+					expand(frontier[i], [&](uint32_t t, uint64_t bits)
+					{
+						if ((bits &= ~tiles[t].visited))
+						{
+							found[s].push_back(FrontierWord{t, bits});
+						}
+					});
+				}
+			});
+			for (const std::vector<FrontierWord>& slice : found)
+			{
+				for (const FrontierWord& f : slice)
+				{
+					merge(f.tile, f.bits);
+				}
+			}
+		}
+		else
+		{
+			for (const FrontierWord& f : frontier)
+			{
+				expand(f, merge);
+			}
+		}
+		if (!next.empty())
+		{
+			levels = level;
+			last = next[0];
+		}
+		frontier.swap(next);
+	}
+	int bit = __builtin_ctzll(last.bits);
+	farCell[0] = (last.tile / tilesPerRow) * 8 + (bit >> 3);
+	farCell[1] = (last.tile % tilesPerRow) * 8 + (bit & 7);
+}
+
+bool MazeSolver::open(int r, int c, direction d) const
+{
+	// passage out of cell r, c
+	switch (d)
+	{
+	case north: return r > 0 && (tiles[cellIndex(r - 1, c) / 64].south >> (cellIndex(r - 1, c) % 64)) & 1;
+	case east: return (tiles[cellIndex(r, c) / 64].east >> (cellIndex(r, c) % 64)) & 1;
+	case south: return (tiles[cellIndex(r, c) / 64].south >> (cellIndex(r, c) % 64)) & 1;
+	case west: return c > 0 && (tiles[cellIndex(r, c - 1) / 64].east >> (cellIndex(r, c - 1) % 64)) & 1;
+	}
+	return false;
+}
+
+bool MazeSolver::hint(int row, int col, direction& towards) const
+{
+	if (dist.empty())
+	{
+		return false;
+	}
+	int r = cellAt(row, nCellRows), c = cellAt(col, nCellCols);
+	uint32_t here = dist[cellIndex(r, c)];
+	if (here == 0 || here == UNREACHED)
+	{
+		return false;
+	}
+	for (int d = north; d <= west; d++)
+	{
+		if (open(r, c, static_cast<direction>(d)) && dist[cellIndex(r + DIRECTION_ROWS[d], c + DIRECTION_COLS[d])] == here - 1)
+		{
+			towards = static_cast<direction>(d);
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<std::pair<int, int>> MazeSolver::path(int row, int col) const
+{
+	std::vector<std::pair<int, int>> steps;
+	if (distance(row, col) == UNREACHED)
+	{
+		return steps;
+	}
+	int r = cellAt(row, nCellRows), c = cellAt(col, nCellCols);
+	steps.push_back({2 * r + 1, 2 * c + 1});
+	direction towards;
+	while (hint(2 * r + 1, 2 * c + 1, towards))
+	{
+		steps.push_back({2 * r + 1 + DIRECTION_ROWS[towards], 2 * c + 1 + DIRECTION_COLS[towards]});
+		r += DIRECTION_ROWS[towards];
+		c += DIRECTION_COLS[towards];
+		steps.push_back({2 * r + 1, 2 * c + 1});
+	}
+	return steps;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "Maze.h"
+#include "MazeGrid.h"
+
+// breadth first distance field from one target cell over a whole maze, in cell steps.
+// the search runs on the cells only, in 8x8 tiles of one 64-bit word each (as TiledGrid):
+// per tile two bit planes say which cells have an open passage east and south, and each
+// BFS level is a sparse list of frontier tiles expanded a word at a time with shifts and
+// masks. most steps stay inside the tile, so a level touches few cache lines. wide levels
+// can be spread over a thread pool, the result is the same
+class MazeSolver
+{
+private:
+	struct Tile
+	{
+		uint64_t east;
+		uint64_t south;
+		uint64_t visited;
+		uint32_t stamp; // last level the tile was added to the frontier of
+		uint32_t slot;  // where in that frontier
+	};
+	struct FrontierWord
+	{
+		uint32_t tile;
+		uint64_t bits;
+	};
+	int nCellRows;
+	int nCellCols;
+	int tilesPerRow;
+	std::vector<Tile> tiles;
+	std::vector<uint32_t> dist; // 64 per tile, in tile bit order
+	int targetCell[2];
+	int farCell[2];
+	uint32_t levels;
+
+	void readPassages(const MazeGrid& grid);
+	void search(unsigned threads);
+	template <class Emit>
+	void expand(const FrontierWord& from, Emit&& emit) const;
+	size_t cellIndex(int r, int c) const
+	{
+		return ((size_t)(r >> 3) * tilesPerRow + (c >> 3)) * 64 + ((r & 7) << 3 | (c & 7));
+	}
+	bool open(int r, int c, direction d) const;
+public:
+	static constexpr uint32_t UNREACHED = 0xffffffffu;
+
+	MazeSolver() : nCellRows(0), nCellCols(0), tilesPerRow(0), targetCell{0, 0}, farCell{0, 0}, levels(0) {}
+	// levels of fewer than a few thousand frontier tiles stay on the calling thread
+	MazeSolver(const MazeGrid& grid, int targetRow, int targetCol, unsigned threads = 0);
+
+	// steps from the cell at row, col to the target, UNREACHED if they are not connected
+	uint32_t distance(int row, int col) const
+	{
+		return dist.empty() ? UNREACHED : dist[cellIndex(cellAt(row, nCellRows), cellAt(col, nCellCols))];
+	}
+	// the way one step closer to the target, false at the target or if it cannot be reached
+	bool hint(int row, int col, direction& towards) const;
+	// grid positions from row, col to the target, passages included
+	std::vector<std::pair<int, int>> path(int row, int col) const;
+	// the largest finite distance and a cell that far from the target, in grid coordinates
+	uint32_t maxDistance() const { return levels; }
+	std::pair<int, int> farthest() const { return {2 * farCell[0] + 1, 2 * farCell[1] + 1}; }
+};
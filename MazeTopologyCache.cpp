@@ -0,0 +1,81 @@
+#include "MazeTopologyCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#if defined(__BMI2__)
+#include <immintrin.h>  // _pdep_u64
+#endif
+
+// rows handed to a thread pool task at a time
+const int TOPOLOGY_BLOCK_ROWS = 64;
+
+// the low 16 bits of x moved to bit 0 of each nibble
+static inline uint64_t spreadNibbles(uint64_t x)
+{
+#if defined(__BMI2__)
+	return _pdep_u64(x, 0x1111111111111111ull);
+#else
+	x &= 0xffff;
+	x = (x | (x << 24)) & 0x000000ff000000ffull;
+	x = (x | (x << 12)) & 0x000f000f000f000full;
+	x = (x | (x << 6)) & 0x0303030303030303ull;
+	x = (x | (x << 3)) & 0x1111111111111111ull;
+	return x;
+#endif
+}
+
+MazeTopologyCache::MazeTopologyCache(const MazeGrid& grid, unsigned threads) : nRows(grid.rows()), nCols(grid.cols()),
+	stride((grid.cols() + 15) / 16), masks((size_t)stride * grid.rows(), 0), rowWalls(grid.rows(), 0), rowFaces(grid.rows(), 0), walls(0), faces(0)
+{
+	// a word of each neighbour plane at a time: shift the row for east and west, take the
+	// rows above and below for north and south. outside the grid reads as open
+	int words = grid.wordsPerRow();
+	std::vector<uint64_t> outside(words, ~0ull);
+	int blocks = (nRows + TOPOLOGY_BLOCK_ROWS - 1) / TOPOLOGY_BLOCK_ROWS;
+	ThreadPool pool(std::min<unsigned>(threads, blocks));
+	pool.parallelFor(blocks, [&](size_t block)
+	{
+		int end = std::min(nRows, (int)(block + 1) * TOPOLOGY_BLOCK_ROWS);
+		for (int row = block * TOPOLOGY_BLOCK_ROWS; row < end; row++)
+		{
+			const uint64_t* here = grid.row(row);
+			const uint64_t* up = row > 0 ? grid.row(row - 1) : outside.data();
+			const uint64_t* down = row + 1 < nRows ? grid.row(row + 1) : outside.data();
+			uint64_t* out = &masks[(size_t)row * stride];
+			uint32_t wallBits = 0, faceBits = 0;
+			for (int w = 0; w < words; w++)
+			{
+				int left = nCols - 64 * w;
+				uint64_t valid = left >= 64 ? ~0ull : (1ull << left) - 1;
+				uint64_t westOpen = here[w] << 1 | (w > 0 ? here[w - 1] >> 63 : 1);
+				uint64_t eastOpen = here[w] >> 1 | (w + 1 < words ? here[w + 1] << 63 : 0);
+				if (left <= 64)
+				{
+					eastOpen |= 1ull << (left - 1);
+				}
+				uint64_t planes[4] = {~up[w] & valid, ~eastOpen & valid, ~down[w] & valid, ~westOpen & valid};
+				uint64_t wall = ~here[w] & valid;
+				wallBits += __builtin_popcountll(wall);
+				for (int d = 0; d < 4; d++)
+				{
+					faceBits += __builtin_popcountll(wall & ~planes[d] & valid);
+				}
+				for (int part = 0; part < 4 && 4 * w + part < stride; part++)
+				{
+					uint64_t nibbles = 0;
+					for (int d = 0; d < 4; d++)
+					{
+						nibbles |= spreadNibbles(planes[d] >> (16 * part)) << d;
+					}
+					out[4 * w + part] = nibbles;
+				}
+			}
+			rowWalls[row] = wallBits;
+			rowFaces[row] = faceBits;
+		}
+	});
+	for (int row = 0; row < nRows; row++)
+	{
+		walls += rowWalls[row];
+		faces += rowFaces[row];
+	}
+}
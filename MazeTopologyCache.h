@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "Maze.h"
+#include "MazeGrid.h"
+
+// per-cell wall neighbour masks of a MazeGrid, built once so the mesher, collision and
+// anything else that asks "which sides of this cell are walls" do a single lookup.
+// bit d of a mask (d a direction) is set when the neighbour that way is a wall; cells
+// outside the grid are open, as with BoundedGrid. masks are packed 16 per word, cell c of
+// a row at bits 4 * (c % 16) of word c / 16
+class MazeTopologyCache
+{
+private:
+	int nRows;
+	int nCols;
+	int stride; // words per row
+	std::vector<uint64_t> masks;
+	std::vector<uint32_t> rowWalls;
+	std::vector<uint32_t> rowFaces;
+	uint64_t walls;
+	uint64_t faces;
+public:
+	MazeTopologyCache() : nRows(0), nCols(0), stride(0), walls(0), faces(0) {}
+	explicit MazeTopologyCache(const MazeGrid& grid, unsigned threads = 0);
+
+	int rows() const { return nRows; }
+	int cols() const { return nCols; }
+
+	unsigned mask(int row, int col) const
+	{
+		return (masks[(size_t)row * stride + (col >> 4)] >> ((col & 15) << 2)) & 15;
+	}
+	bool wallTowards(int row, int col, direction d) const
+	{
+		return (mask(row, col) >> d) & 1;
+	}
+	// a cell's own wall bit is the matching bit of the cell beside it, still one lookup,
+	// so the cache stands in for the grid in Camera collision. bounded like BoundedGrid
+	bool isWall(int64_t row, int64_t col) const
+	{
+		if (row < 0 || col < 0 || row >= nRows || col >= nCols)
+		{
+			return false;
+		}
+		if (col > 0)
+		{
+			return wallTowards(row, col - 1, east);
+		}
+		if (col + 1 < nCols)
+		{
+			return wallTowards(row, col + 1, west);
+		}
+		// a single column, ask the position above or below instead
+		if (row > 0)
+		{
+			return wallTowards(row - 1, col, south);
+		}
+		if (row + 1 < nRows)
+		{
+			return wallTowards(row + 1, col, north);
+		}
+		return true; // 1x1 has no neighbour to ask, and grids that small are all wall (see Maze)
+	}
+
+	// wall cells, and wall faces that border an open cell or the outside, per row and in total
+	uint32_t wallsInRow(int row) const { return rowWalls[row]; }
+	uint32_t facesInRow(int row) const { return rowFaces[row]; }
+	uint64_t wallCount() const { return walls; }
+	uint64_t faceCount() const { return faces; }
+};
@@ -0,0 +1,69 @@
+#include "PagedGrid.h"
+#include <algorithm>
+#include <iostream>
+
+PagedGrid::PagedGrid() : nRows(0), nCols(0), stride(0), rowsPerPage(1), maxPages(1), payloadOffset(0), header{}, lastPage(-1), lastWords(nullptr), reads(0)
+{
+}
+
+bool PagedGrid::open(const std::string& path, size_t memoryBudget, size_t pageBytes)
+{
+	file.close();
+	file.clear();
+	pages.clear();
+	recent.clear();
+	lastPage = -1;
+	lastWords = nullptr;
+	reads = 0;
+	file.open(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		std::cout << "Failed to open level " << path << std::endl;
+		return false;
+	}
+	uint64_t length = file.tellg();
+	file.seekg(0);
+	if (length < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) || !checkLevelHeader(header, length, path))
+	{
+		return false;
+	}
+	nRows = header.rows;
+	nCols = header.cols;
+	stride = header.wordsPerRow;
+	payloadOffset = header.payloadOffset;
+	size_t rowBytes = std::max<size_t>(1, (size_t)stride * sizeof(uint64_t));
+	rowsPerPage = std::max<size_t>(1, pageBytes / rowBytes);
+	maxPages = std::max<size_t>(1, memoryBudget / (rowsPerPage * rowBytes));
+	return true;
+}
+
+const uint64_t* PagedGrid::loadPage(int page) const
+{
+	auto found = pages.find(page);
+	if (found != pages.end())
+	{
+		recent.splice(recent.begin(), recent, found->second.used);
+	}
+	else
+	{
+		if (pages.size() >= maxPages)
+		{
+			pages.erase(recent.back());
+			recent.pop_back();
+		}
+		int first = page * rowsPerPage;
+		int count = std::min(rowsPerPage, nRows - first);
+		recent.push_front(page);
+		Page& loaded = pages[page];
+		loaded.used = recent.begin();
+		loaded.words.resize((size_t)count * stride);
+		file.clear();
+		file.seekg(payloadOffset + (uint64_t)first * stride * sizeof(uint64_t));
+		file.read(reinterpret_cast<char*>(loaded.words.data()), loaded.words.size() * sizeof(uint64_t));
+		reads++;
+		found = pages.find(page);
+	}
+	lastPage = page;
+	lastWords = found->second.words.data();
+	return lastWords;
+}
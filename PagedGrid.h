@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LevelFile.h"
+
+// read-only grid over a level file that can be far larger than memory. rows are read in
+// pages of whole rows and the most recently used pages are kept up to a memory budget.
+// offers the same read interface as MazeGrid, so code templated on the grid (BoundedGrid,
+// the mesher, Camera collision) works on both. the solvers and pathfinders (MazeSolver,
+// CorridorGraph, FlowField, HierarchicalPathfinder, DeadEndSolver, KeyDoorPuzzle) take a
+// MazeGrid only: each keeps state at least the size of the bit grid in memory (MazeSolver a
+// 32 bit distance per cell, DeadEndSolver a copy of the grid), so a level too large for
+// memory could not be solved through pages either. load it into a Maze first.
+// lookups move pages in and out, so a PagedGrid must not be shared between threads
+class PagedGrid
+{
+private:
+	struct Page
+	{
+		std::vector<uint64_t> words;
+		std::list<int>::iterator used;
+	};
+	int nRows;
+	int nCols;
+	int stride;
+	int rowsPerPage;
+	size_t maxPages;
+	uint64_t payloadOffset;
+	LevelHeader header;
+	mutable std::ifstream file;
+	mutable std::unordered_map<int, Page> pages;
+	mutable std::list<int> recent; // most recently used first
+	mutable int lastPage;
+	mutable const uint64_t* lastWords;
+	mutable size_t reads;
+
+	const uint64_t* loadPage(int page) const;
+public:
+	PagedGrid();
+	// pageBytes is rounded to whole rows, at least one
+	bool open(const std::string& path, size_t memoryBudget, size_t pageBytes = 1 << 18);
+	const LevelHeader& getHeader() const { return header; }
+	size_t pageReads() const { return reads; }
+	size_t pagesHeld() const { return pages.size(); }
+
+	int rows() const { return nRows; }
+	int cols() const { return nCols; }
+	int wordsPerRow() const { return stride; }
+
+	// valid until the next lookup on this grid
+	const uint64_t* row(int row) const
+	{
+		int page = row / rowsPerPage;
+		const uint64_t* words = page == lastPage ? lastWords : loadPage(page);
+		return words + (size_t)(row - page * rowsPerPage) * stride;
+	}
+	bool isWall(int row, int col) const
+	{
+		return !((this->row(row)[col >> 6] >> (col & 63)) & 1);
+	}
+	bool isOpen(int row, int col) const
+	{
+		return !isWall(row, col);
+	}
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+// one splitmix64 step, expands a single seed into a stream of well mixed words
+constexpr uint64_t splitmix64(uint64_t& state)
+{
+	uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+// hashes value into seed, for deriving independent streams (per tile, per chunk, ...)
+constexpr uint64_t mixSeed(uint64_t seed, uint64_t value)
+{
+	uint64_t state = seed ^ (value * 0xd1b54a32d192ed03ull);
+	return splitmix64(state);
+}
+
+// xoshiro256** generator. cheap enough to draw from for every carved cell, and
+// fully determined by its seed so mazes can be reproduced
+class Rng
+{
+private:
+	uint64_t s[4];
+
+	static constexpr uint64_t rotl(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+public:
+	constexpr explicit Rng(uint64_t seed) : s{}
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			s[i] = splitmix64(seed);
+		}
+	}
+
+	constexpr uint64_t next()
+	{
+		uint64_t result = rotl(s[1] * 5, 7) * 9;
+		uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	// integer in [0, bound) by multiply and shift, bias is below bound / 2^32
+	constexpr uint32_t below(uint32_t bound)
+	{
+		return static_cast<uint32_t>(((next() >> 32) * bound) >> 32);
+	}
+};
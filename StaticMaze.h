@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include "MazeGrid.h"
+#include "Rng.h"
+
+// fixed size maze grid that can be built in a constant expression, so small fixed levels
+// are generated by the compiler and end up in read only data
+template <int Size>
+struct StaticGrid
+{
+	bool walls[Size][Size];
+
+	constexpr int rows() const { return Size; }
+	constexpr int cols() const { return Size; }
+	// bounds checked like BoundedGrid, nothing outside the grid counts as a wall
+	constexpr bool isWall(int64_t row, int64_t col) const
+	{
+		return row >= 0 && col >= 0 && row < Size && col < Size && walls[row][col];
+	}
+	constexpr int wallCount() const
+	{
+		int count = 0;
+		for (int row = 0; row < Size; row++)
+		{
+			for (int col = 0; col < Size; col++)
+			{
+				count += walls[row][col];
+			}
+		}
+		return count;
+	}
+	MazeGrid toGrid() const
+	{
+		MazeGrid grid(Size, Size);
+		for (int row = 0; row < Size; row++)
+		{
+			for (int col = 0; col < Size; col++)
+			{
+				if (!walls[row][col])
+				{
+					grid.setOpen(row, col);
+				}
+			}
+		}
+		return grid;
+	}
+};
+
+// the same depth first search as Maze::carve with the same draws from Rng, so
+// staticMaze<Size, Seed>() matches Maze(Size, dfsIterative, Seed) cell for cell.
+// meant for small levels, large ones run into the compiler's constexpr step limit
+template <int Size, uint64_t Seed>
+constexpr StaticGrid<Size> staticMaze()
+{
+	static_assert(Size >= 3 && Size % 2 == 1, "maze size must be odd");
+	StaticGrid<Size> grid{};
+	for (int row = 0; row < Size; row++)
+	{
+		for (int col = 0; col < Size; col++)
+		{
+			grid.walls[row][col] = true;
+		}
+	}
+	Rng rng(Seed);
+	// every cell is on the stack at most once
+	uint32_t stack[(Size / 2) * (Size / 2)] = {};
+	int depth = 0;
+	grid.walls[1][1] = false;
+	stack[depth++] = Size + 1;
+	while (depth > 0)
+	{
+		int row = stack[depth - 1] / Size;
+		int col = stack[depth - 1] % Size;
+		int dRows[4] = {}, dCols[4] = {};
+		int count = 0;
+		if (row - 2 >= 1 && grid.walls[row - 2][col])
+		{
+			dRows[count] = -1; dCols[count++] = 0;
+		}
+		if (col + 2 <= Size - 2 && grid.walls[row][col + 2])
+		{
+			dRows[count] = 0; dCols[count++] = 1;
+		}
+		if (row + 2 <= Size - 2 && grid.walls[row + 2][col])
+		{
+			dRows[count] = 1; dCols[count++] = 0;
+		}
+		if (col - 2 >= 1 && grid.walls[row][col - 2])
+		{
+			dRows[count] = 0; dCols[count++] = -1;
+		}
+		if (count == 0)
+		{
+			depth--;
+			continue;
+		}
+		uint32_t pick = rng.below(count);
+		grid.walls[row + dRows[pick]][col + dCols[pick]] = false;
+		grid.walls[row + 2 * dRows[pick]][col + 2 * dCols[pick]] = false;
+		stack[depth++] = static_cast<uint32_t>(row + 2 * dRows[pick]) * Size + col + 2 * dCols[pick];
+	}
+	return grid;
+}
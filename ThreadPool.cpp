@@ -0,0 +1,85 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned threads) : pending(0), stopping(false)
+{
+	if (threads == 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (unsigned i = 0; i < threads; i++)
+	{
+		workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	taskReady.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::work()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			taskReady.wait(guard, [this] { return stopping || !tasks.empty(); });
+			if (tasks.empty())
+			{
+				return;
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+		std::lock_guard<std::mutex> guard(lock);
+		if (--pending == 0)
+		{
+			allDone.notify_all();
+		}
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		tasks.push_back(std::move(task));
+		pending++;
+	}
+	taskReady.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	allDone.wait(guard, [this] { return pending == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+	// each worker pulls the next index until none are left
+	std::atomic<size_t> next(0);
+	for (unsigned i = 0; i < size(); i++)
+	{
+		submit([&next, &body, count]
+		{
+			for (size_t index = next++; index < count; index = next++)
+			{
+				body(index);
+			}
+		});
+	}
+	wait();
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads running queued tasks. tasks may submit further tasks
+class ThreadPool
+{
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex lock;
+	std::condition_variable taskReady;
+	std::condition_variable allDone;
+	size_t pending; // queued plus running
+	bool stopping;
+
+	void work();
+public:
+	// threads = 0 uses one worker per hardware thread. everything else taking a threads
+	// count (Maze, MazeSolver, ...) hands it on to a pool, so 0 means the same there
+	explicit ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+	unsigned size() const { return workers.size(); }
+	void submit(std::function<void()> task);
+	// blocks until every submitted task has finished
+	void wait();
+	// runs body(i) for every i in [0, count) across the workers and waits for all of them
+	void parallelFor(size_t count, const std::function<void(size_t)>& body);
+};
@@ -0,0 +1,32 @@
+#include "TiledGrid.h"
+
+TiledGrid::TiledGrid(const MazeGrid& grid) : TiledGrid(grid.rows(), grid.cols())
+{
+	// every grid word holds one byte of eight neighbouring tiles
+	for (int row = 0; row < nRows; row++)
+	{
+		const uint64_t* words = grid.row(row);
+		uint64_t* tileRow = &tiles[(size_t)(row >> 3) * tilesPerRow];
+		int shift = (row & 7) << 3;
+		for (int t = 0; t < tilesPerRow; t++)
+		{
+			tileRow[t] |= ((words[t >> 3] >> ((t & 7) << 3)) & 0xff) << shift;
+		}
+	}
+}
+
+MazeGrid TiledGrid::toGrid() const
+{
+	MazeGrid grid(nRows, nCols);
+	for (int row = 0; row < nRows; row++)
+	{
+		uint64_t* words = grid.row(row);
+		const uint64_t* tileRow = &tiles[(size_t)(row >> 3) * tilesPerRow];
+		int shift = (row & 7) << 3;
+		for (int t = 0; t < tilesPerRow; t++)
+		{
+			words[t >> 3] |= ((tileRow[t] >> shift) & 0xff) << ((t & 7) << 3);
+		}
+	}
+	return grid;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "MazeGrid.h"
+
+// maze cells in 8x8 tiles, one 64-bit word per tile, tiles stored row-major. a cell's
+// 3x3 neighbourhood is then in one to four words instead of on three rows far apart, which
+// is what collision and flood fills over wide grids touch. same cell interface as MazeGrid,
+// set bit open. bit (row % 8) * 8 + col % 8 of a tile is its cell.
+// optional: the game keeps MazeGrid, and at the width mazeBench compares this layout did
+// not pay off
+class TiledGrid
+{
+private:
+	int nRows;
+	int nCols;
+	int tilesPerRow;
+	std::vector<uint64_t> tiles;
+public:
+	TiledGrid() : nRows(0), nCols(0), tilesPerRow(0) {}
+	TiledGrid(int rows, int cols) : nRows(rows), nCols(cols), tilesPerRow((cols + 7) / 8), tiles((size_t)tilesPerRow * ((rows + 7) / 8), 0) {}
+	explicit TiledGrid(const MazeGrid& grid);
+	MazeGrid toGrid() const;
+
+	int rows() const { return nRows; }
+	int cols() const { return nCols; }
+	size_t tileCount() const { return tiles.size(); }
+
+	bool isWall(int row, int col) const
+	{
+		return !((tiles[(size_t)(row >> 3) * tilesPerRow + (col >> 3)] >> (((row & 7) << 3) | (col & 7))) & 1);
+	}
+	bool isOpen(int row, int col) const
+	{
+		return !isWall(row, col);
+	}
+	void setOpen(int row, int col)
+	{
+		tiles[(size_t)(row >> 3) * tilesPerRow + (col >> 3)] |= uint64_t(1) << (((row & 7) << 3) | (col & 7));
+	}
+	void setWall(int row, int col)
+	{
+		tiles[(size_t)(row >> 3) * tilesPerRow + (col >> 3)] &= ~(uint64_t(1) << (((row & 7) << 3) | (col & 7)));
+	}
+	// the tile holding rows 8 * tileRow.. and columns 8 * tileCol..
+	uint64_t tile(int tileRow, int tileCol) const { return tiles[(size_t)tileRow * tilesPerRow + tileCol]; }
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// disjoint sets over 0..n-1 kept in flat arrays, with path compression and union by rank
+class UnionFind
+{
+private:
+	std::vector<uint32_t> parent;
+	std::vector<uint8_t> rank;
+public:
+	explicit UnionFind(uint32_t n) : parent(n), rank(n, 0)
+	{
+		std::iota(parent.begin(), parent.end(), 0);
+	}
+
+	uint32_t find(uint32_t x)
+	{
+		// path halving, every visited node is pointed at its grandparent
+		while (parent[x] != x)
+		{
+			parent[x] = parent[parent[x]];
+			x = parent[x];
+		}
+		return x;
+	}
+
+	// joins the sets holding a and b, false if they already were the same set
+	bool unite(uint32_t a, uint32_t b)
+	{
+		a = find(a);
+		b = find(b);
+		if (a == b)
+		{
+			return false;
+		}
+		if (rank[a] < rank[b])
+		{
+			std::swap(a, b);
+		}
+		parent[b] = a;
+		if (rank[a] == rank[b])
+		{
+			rank[a]++;
+		}
+		return true;
+	}
+};
@@ -0,0 +1,99 @@
+#include "WallSumTable.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+// columns summed per thread pool task in the second pass, a few cache lines of every row
+const int SUM_BLOCK_COLS = 1024;
+// changes kept aside before they are folded into the table
+const size_t SUM_PENDING_LIMIT = 256;
+
+WallSumTable::WallSumTable(const MazeGrid& grid, unsigned threads) : nRows(grid.rows()), nCols(grid.cols()),
+	sums((size_t)(grid.rows() + 1) * (grid.cols() + 1), 0)
+{
+	ThreadPool pool(threads);
+	size_t stride = nCols + 1;
+	// running wall count along every row
+	pool.parallelFor(nRows, [&](size_t row)
+	{
+		const uint64_t* words = grid.row(row);
+		uint32_t* out = &sums[(row + 1) * stride + 1];
+		uint32_t running = 0;
+		for (int col = 0; col < nCols; col++)
+		{
+			running += !((words[col >> 6] >> (col & 63)) & 1);
+			out[col] = running;
+		}
+	});
+	// then down every column, a block of columns per task
+	int blocks = (nCols + SUM_BLOCK_COLS) / SUM_BLOCK_COLS;
+	pool.parallelFor(blocks, [&](size_t block)
+	{
+		size_t from = block * SUM_BLOCK_COLS + 1;
+		size_t to = std::min(stride, from + SUM_BLOCK_COLS);
+		for (int row = 2; row <= nRows; row++)
+		{
+			const uint32_t* above = &sums[(row - 1) * stride];
+			uint32_t* here = &sums[row * stride];
+			for (size_t col = from; col < to; col++)
+			{
+				here[col] += above[col];
+			}
+		}
+	});
+}
+
+int64_t WallSumTable::wallCount(int row0, int col0, int row1, int col1) const
+{
+	row0 = std::max(row0, 0);
+	col0 = std::max(col0, 0);
+	row1 = std::min(row1, nRows);
+	col1 = std::min(col1, nCols);
+	if (row0 >= row1 || col0 >= col1)
+	{
+		return 0;
+	}
+	int64_t count = (int64_t)at(row1, col1) - at(row0, col1) - at(row1, col0) + at(row0, col0);
+	for (const Change& change : pending)
+	{
+		if (change.row >= row0 && change.row < row1 && change.col >= col0 && change.col < col1)
+		{
+			count += change.delta;
+		}
+	}
+	return count;
+}
+
+void WallSumTable::wallChanged(int row, int col, bool wall)
+{
+	pending.push_back(Change{row, col, wall ? 1 : -1});
+	if (pending.size() >= SUM_PENDING_LIMIT)
+	{
+		applyPending();
+	}
+}
+
+void WallSumTable::applyPending()
+{
+	// one sweep down the table from the first changed row: offset[c] is the sum of the
+	// changes passed so far that lie left of column c, and is added to every later row
+	std::sort(pending.begin(), pending.end(), [](const Change& a, const Change& b) { return a.row < b.row; });
+	size_t stride = nCols + 1;
+	std::vector<int32_t> offset(stride, 0);
+	size_t next = 0;
+	for (int row = pending.front().row + 1; row <= nRows; row++)
+	{
+		for (; next < pending.size() && pending[next].row < row; next++)
+		{
+			for (size_t col = pending[next].col + 1; col < stride; col++)
+			{
+				offset[col] += pending[next].delta;
+			}
+		}
+		uint32_t* here = &sums[row * stride];
+		for (size_t col = 0; col < stride; col++)
+		{
+			here[col] += offset[col];
+		}
+	}
+	pending.clear();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "MazeGrid.h"
+
+// summed-area table of the walls in a MazeGrid, for counting the walls in any rectangle in
+// constant time (empty chunks, vertex buffer sizes, spawn regions, coarse visibility).
+// entry (r, c) holds the walls above and left of grid cell (r, c), so the table is one row
+// and column larger than the grid. 4 bytes per cell, so it suits levels that are loaded
+// rather than paged
+class WallSumTable
+{
+private:
+	struct Change
+	{
+		int row;
+		int col;
+		int delta;
+	};
+	int nRows;
+	int nCols;
+	std::vector<uint32_t> sums;
+	std::vector<Change> pending;
+
+	uint32_t at(int row, int col) const { return sums[(size_t)row * (nCols + 1) + col]; }
+	void applyPending();
+public:
+	WallSumTable() : nRows(0), nCols(0) {}
+	// rows in parallel, then columns
+	explicit WallSumTable(const MazeGrid& grid, unsigned threads = 0);
+
+	int rows() const { return nRows; }
+	int cols() const { return nCols; }
+
+	// walls in rows row0..row1 - 1 and columns col0..col1 - 1, the same half open ranges as meshRegion
+	int64_t wallCount(int row0, int col0, int row1, int col1) const;
+	// record that the cell at row, col became a wall (or stopped being one). changes are kept
+	// aside and counted into queries until enough pile up to fold them into the table in one pass.
+	// the table does not see the grid, so report each real change exactly once: a repeat, or a
+	// call for a cell that did not change, is counted as another wall gained or lost
+	void wallChanged(int row, int col, bool wall);
+};
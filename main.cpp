@@ -8,6 +8,13 @@
 #include "Camera.h"
 #include <iostream>
 #include "Maze.h"
+#include "ChunkWorld.h"
+#include "PagedGrid.h"
+#include "StaticMaze.h"
+#include "EdgeGrid.h"
+#include "MazeTopologyCache.h"
+#include "MazeSolver.h"
+#include <array>
 #include <chrono>
 #include <thread>
 
@@ -20,6 +27,14 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
 GLFWwindow* setup();
 void mazeInit();
+bool worldInit();
+bool pagedInit();
+template <class Grid>
+void meshRegion(const Grid& grid, int rowFrom, int rowTo, int colFrom, int colTo, int rowOffset, int colOffset);
+void addCell(int row, int col, bool wall);
+void meshTopology(const MazeTopologyCache& cache);
+void addWallFaces(int row, int col, unsigned openSides);
+void uploadMesh(unsigned int VBO, unsigned int VBOFLOOR);
 unsigned int loadCubemap(std::vector<std::string> faces);
 bool inCorner();
 
@@ -36,8 +51,20 @@ float deltaTime = 0.0f;	// time between current frame and last frame
 float lastFrame = 0.0f;
 
 const int MAZE_SIZE = 11;
+// F5 saves the current level here, run with a level file as argument to play it again
+const char* LEVEL_FILE = "level.glmz";
+// levels with more cells than this are paged in from disk around the camera instead of loaded
+const uint64_t PAGED_LEVEL_CELLS = 1ull << 26;
+const size_t PAGED_BUDGET = 64 << 20; // bytes of level pages kept in memory
+const int PAGED_VIEW = 48; // cells meshed in each direction around the camera
+// keep a loaded or generated level as an EdgeGrid, half the memory of the full grid
+const bool EDGE_LEVEL = false;
+// endless chunked maze instead of the single MAZE_SIZE level
+const bool INFINITE_WORLD = false;
+const int WORLD_RADIUS = 2; // chunks loaded around the camera
+const size_t WORLD_CACHE = 64; // chunks kept before the least recently used are dropped
 // will shift cube around for maze
-const float CUBE_VERTICES[] =
+constexpr float CUBE_VERTICES[] =
 {
 	-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
 	0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
@@ -82,7 +109,7 @@ const float CUBE_VERTICES[] =
 	-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
 };
 
-const float FLOOR[] =
+constexpr float FLOOR[] =
   { // vertex - texture
    0.5f, -0.5f, 0.5f, 1.0f, 1.0f, // forward right
    0.5f, -0.5f, -0.5f, 1.0f, 0.0f, // back right
@@ -92,15 +119,98 @@ const float FLOOR[] =
    -0.5f, -0.5f, 0.5f, 0.0f, 1.0f // forward left -> describes a cube laying down relative camera
    };
 
+// fixed tutorial level, generated and meshed at compile time instead of a random MAZE_SIZE
+// maze. a level file given on the command line still takes precedence
+const bool TUTORIAL_LEVEL = false;
+const uint64_t TUTORIAL_SEED = 11;
+
+template <size_t Count, int Size, size_t Floats>
+constexpr std::array<float, Count * Floats> bakeCells(const StaticGrid<Size>& grid, const float (&unit)[Floats], bool wall)
+{
+	// unit copied to every cell that is (or is not) a wall, shifted the same way as addCell
+	std::array<float, Count * Floats> vertices{};
+	size_t out = 0;
+	for (int row = 0; row < Size; row++)
+	{
+		for (int col = 0; col < Size; col++)
+		{
+			if (grid.isWall(row, col) != wall)
+				continue;
+			for (size_t i = 0; i < Floats; i += 5)
+			{
+				vertices[out++] = unit[i] + row;
+				vertices[out++] = unit[i+1];
+				vertices[out++] = unit[i+2] - col;
+				vertices[out++] = unit[i+3];
+				vertices[out++] = unit[i+4]; // texcoords
+			}
+		}
+	}
+	return vertices;
+}
+
+constexpr StaticGrid<MAZE_SIZE> TUTORIAL = staticMaze<MAZE_SIZE, TUTORIAL_SEED>();
+constexpr int TUTORIAL_WALLS = TUTORIAL.wallCount();
+constexpr auto TUTORIAL_CUBES = bakeCells<TUTORIAL_WALLS>(TUTORIAL, CUBE_VERTICES, true);
+constexpr auto TUTORIAL_FLOOR = bakeCells<MAZE_SIZE * MAZE_SIZE - TUTORIAL_WALLS>(TUTORIAL, FLOOR, false);
+
+// CUBE_VERTICES face (30 floats each) seen from the neighbour in each direction, x is row
+// and -z is col. face 5 is the top, face 4 the bottom that sits on the floor
+const int CUBE_FACE[] = {2, 0, 3, 1};
+const int CUBE_TOP = 5;
+
 std::vector<float> cubes_shifted{};
 std::vector<float> floor_shifted{};
 
 Maze m{MAZE_SIZE};
-
-int main()
+std::unique_ptr<ChunkWorld> world;
+unsigned worldVersion = 0;
+bool levelSaved = false;
+PagedGrid paged;
+bool pagedLevel = false;
+bool tutorialLevel = false;
+EdgeGrid edges;
+MazeTopologyCache topology;
+MazeSolver solver;
+bool hintHeld = false;
+bool edgeLevel = false;
+int pagedRow = -PAGED_VIEW, pagedCol = -PAGED_VIEW; // centre of the current paged mesh
+
+int main(int argc, char** argv)
 {
+	if (argc > 1)
+	{
+		if (!paged.open(argv[1], PAGED_BUDGET))
+		{
+			return 1;
+		}
+		pagedLevel = (uint64_t)paged.rows() * paged.cols() > PAGED_LEVEL_CELLS;
+		if (!pagedLevel && !m.load(argv[1]))
+		{
+			return 1;
+		}
+	}
+	tutorialLevel = TUTORIAL_LEVEL && argc <= 1;
+	edgeLevel = EDGE_LEVEL && !pagedLevel && !tutorialLevel;
+	if (edgeLevel)
+	{
+		edges = EdgeGrid(m.data);
+		m = Maze();
+	}
 	GLFWwindow* window = setup();
-	mazeInit();
+	if (INFINITE_WORLD)
+	{
+		world.reset(new ChunkWorld(clockSeed(), WORLD_CACHE));
+		world->update(camera.Position.x, -camera.Position.z, WORLD_RADIUS);
+	}
+	else if (pagedLevel)
+	{
+		pagedInit();
+	}
+	else
+	{
+		mazeInit();
+	}
 	// skybox file locations
 	std::vector<std::string> faces =
 	  {
@@ -178,7 +288,7 @@ int main()
 	glGenBuffers(1, &VBO);
 	glBindVertexArray(VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float)*cubes_shifted.size(), &cubes_shifted[0], GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float)*cubes_shifted.size(), cubes_shifted.data(), GL_STATIC_DRAW);
 	// position attribute
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
@@ -220,7 +330,7 @@ int main()
 	glGenBuffers(1, &VBOFLOOR);
 	glBindVertexArray(VAOFLOOR);
 	glBindBuffer(GL_ARRAY_BUFFER, VBOFLOOR);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float)*floor_shifted.size(), &floor_shifted[0], GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float)*floor_shifted.size(), floor_shifted.data(), GL_STATIC_DRAW);
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void*)(3*sizeof(float)));
@@ -257,7 +367,19 @@ int main()
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		if (inCorner())
+		if (INFINITE_WORLD)
+		  {
+		    world->update(camera.Position.x, -camera.Position.z, WORLD_RADIUS);
+		    if (worldInit())
+		      {
+			uploadMesh(VBO, VBOFLOOR);
+		      }
+		  }
+		else if (pagedLevel && pagedInit())
+		  {
+		    uploadMesh(VBO, VBOFLOOR);
+		  }
+		if (!INFINITE_WORLD && inCorner())
 		  {
 		    std::cout << "you won!, total time taken: " << glfwGetTime() << std::endl;
 		    glDeleteVertexArrays(1, &VAO);
@@ -314,15 +436,45 @@ void processInput(GLFWwindow* window)
 {
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_F5) == GLFW_PRESS && !INFINITE_WORLD && !pagedLevel && !tutorialLevel && !edgeLevel && !levelSaved)
+		levelSaved = m.save(LEVEL_FILE);
+	// H prints which way the goal is, once per press
+	bool hintPressed = glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS;
+	if (hintPressed && !hintHeld && !INFINITE_WORLD && !pagedLevel)
+	{
+		const char* names[] = {"north (-x)", "east (-z)", "south (+x)", "west (+z)"};
+		int row = (int)std::round(camera.Position.x);
+		int col = (int)std::round(-camera.Position.z);
+		direction towards;
+		if (solver.hint(row, col, towards))
+			std::cout << "Hint: go " << names[towards] << ", " << solver.distance(row, col) << " cells to the goal" << std::endl;
+	}
+	hintHeld = hintPressed;
 
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-	  camera.ProcessKeyboard(FORWARD, deltaTime, m);
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-	  camera.ProcessKeyboard(BACKWARD, deltaTime, m);
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-	  camera.ProcessKeyboard(LEFT, deltaTime, m);
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-	  camera.ProcessKeyboard(RIGHT, deltaTime, m);
+	Camera_Movement moves[] = {FORWARD, BACKWARD, LEFT, RIGHT};
+	int keys[] = {GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D};
+	for (int i = 0; i < 4; i++)
+	{
+		if (glfwGetKey(window, keys[i]) == GLFW_PRESS)
+		{
+			if (INFINITE_WORLD)
+				camera.ProcessKeyboard(moves[i], deltaTime, *world);
+			else if (pagedLevel)
+			{
+				BoundedGrid<PagedGrid> level{paged};
+				camera.ProcessKeyboard(moves[i], deltaTime, level);
+			}
+			else if (edgeLevel)
+			{
+				BoundedGrid<EdgeGrid> level{edges};
+				camera.ProcessKeyboard(moves[i], deltaTime, level);
+			}
+			else if (tutorialLevel)
+				camera.ProcessKeyboard(moves[i], deltaTime, TUTORIAL);
+			else
+				camera.ProcessKeyboard(moves[i], deltaTime, topology);
+		}
+	}
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
@@ -393,52 +545,172 @@ void mazeInit()
 {
 	// generates maze, adds cube positions based on maze data
 	//m = Maze(MAZE_SIZE);
-	for (int row = 0; row < MAZE_SIZE; row++)
+	if (tutorialLevel)
 	{
-		for (int col = 0; col < MAZE_SIZE; col++)
+		// already meshed by the compiler
+		cubes_shifted.assign(TUTORIAL_CUBES.begin(), TUTORIAL_CUBES.end());
+		floor_shifted.assign(TUTORIAL_FLOOR.begin(), TUTORIAL_FLOOR.end());
+		MazeGrid grid = TUTORIAL.toGrid();
+		solver = MazeSolver(grid, grid.rows() - 2, grid.cols() - 2);
+		return;
+	}
+	if (edgeLevel)
+	{
+		meshRegion(edges, 0, edges.rows(), 0, edges.cols(), 0, 0);
+		MazeGrid grid = edges.toGrid();
+		solver = MazeSolver(grid, grid.rows() - 2, grid.cols() - 2);
+		return;
+	}
+	topology = MazeTopologyCache(m.data);
+	meshTopology(topology);
+	// distances to the goal corner, for the hint key
+	solver = MazeSolver(m.data, m.data.rows() - 2, m.data.cols() - 2);
+}
+
+bool worldInit()
+{
+	// rebuilds the vertices from every loaded chunk around the camera, false if nothing changed
+	unsigned version = world->version();
+	if (version == worldVersion)
+	{
+		return false;
+	}
+	worldVersion = version;
+	cubes_shifted.clear();
+	floor_shifted.clear();
+	int centreRow = (int)std::floor(camera.Position.x / CHUNK_SPAN);
+	int centreCol = (int)std::floor(-camera.Position.z / CHUNK_SPAN);
+	for (int chunkRow = centreRow - WORLD_RADIUS; chunkRow <= centreRow + WORLD_RADIUS; chunkRow++)
+	{
+		for (int chunkCol = centreCol - WORLD_RADIUS; chunkCol <= centreCol + WORLD_RADIUS; chunkCol++)
 		{
-			if (!m.data[row][col]) // if wall generate new cube
+			std::shared_ptr<const MazeGrid> grid = world->chunk(chunkRow, chunkCol);
+			if (!grid)
 			{
-				// x is row, depth is col, all at same height y
-				//cube_positions.push_back(glm::vec3((float)row, 0.0f, -(float)col));
-				glm::vec3 shift = glm::vec3((float)row, 0.0f, -(float)col);
-				glm::mat4 model = glm::mat4(1.0f);
-				model = glm::translate(model, shift);
-				for (int i = 0; i < 180; i += 5) // 48 is num vertices + tex for cube
-				  {
-				    glm::vec4 newVert = glm::vec4(CUBE_VERTICES[i], CUBE_VERTICES[i+1], CUBE_VERTICES[i+2], 1.0);
-				    newVert = model*newVert;
-				    cubes_shifted.push_back(newVert.x);
-				    cubes_shifted.push_back(newVert.y);
-				    cubes_shifted.push_back(newVert.z);
-				    cubes_shifted.push_back(CUBE_VERTICES[i+3]);
-				    cubes_shifted.push_back(CUBE_VERTICES[i+4]); // texcoords
-				  }
+				continue;
 			}
+			// the last row and column belong to the next chunk
+			meshRegion(*grid, 0, CHUNK_SPAN, 0, CHUNK_SPAN, chunkRow * CHUNK_SPAN, chunkCol * CHUNK_SPAN);
+		}
+	}
+	return true;
+}
+
+bool pagedInit()
+{
+	// remeshes the part of a paged level around the camera once it has moved far enough
+	int row = (int)camera.Position.x;
+	int col = (int)-camera.Position.z;
+	if (std::abs(row - pagedRow) < PAGED_VIEW / 2 && std::abs(col - pagedCol) < PAGED_VIEW / 2)
+	{
+		return false;
+	}
+	pagedRow = row;
+	pagedCol = col;
+	cubes_shifted.clear();
+	floor_shifted.clear();
+	meshRegion(paged, std::max(0, row - PAGED_VIEW), std::min(paged.rows(), row + PAGED_VIEW),
+		std::max(0, col - PAGED_VIEW), std::min(paged.cols(), col + PAGED_VIEW), 0, 0);
+	return true;
+}
+
+template <class Grid>
+void meshRegion(const Grid& grid, int rowFrom, int rowTo, int colFrom, int colTo, int rowOffset, int colOffset)
+{
+	// grid is a MazeGrid, PagedGrid or EdgeGrid, cells are placed at their row and col plus the offsets
+	for (int row = rowFrom; row < rowTo; row++)
+	{
+		for (int col = colFrom; col < colTo; col++)
+		{
+			addCell(row + rowOffset, col + colOffset, grid.isWall(row, col));
+		}
+	}
+}
+
+void addCell(int row, int col, bool wall)
+{
+	// x is row, depth is col, all at same height y
+	glm::vec3 shift = glm::vec3((float)row, 0.0f, -(float)col);
+	glm::mat4 model = glm::mat4(1.0f);
+	model = glm::translate(model, shift);
+	if (wall) // if wall generate new cube
+	{
+		for (int i = 0; i < 180; i += 5) // 48 is num vertices + tex for cube
+		  {
+		    glm::vec4 newVert = glm::vec4(CUBE_VERTICES[i], CUBE_VERTICES[i+1], CUBE_VERTICES[i+2], 1.0);
+		    newVert = model*newVert;
+		    cubes_shifted.push_back(newVert.x);
+		    cubes_shifted.push_back(newVert.y);
+		    cubes_shifted.push_back(newVert.z);
+		    cubes_shifted.push_back(CUBE_VERTICES[i+3]);
+		    cubes_shifted.push_back(CUBE_VERTICES[i+4]); // texcoords
+		  }
+	}
+	else
+	  {
+	    for (int i = 0; i < 30; i += 5) // 30 is num vertices + tex for cube
+	      {
+		glm::vec4 newVert = glm::vec4(FLOOR[i], FLOOR[i+1], FLOOR[i+2], 1.0);
+		newVert = model*newVert;
+		floor_shifted.push_back(newVert.x);
+		floor_shifted.push_back(newVert.y);
+		floor_shifted.push_back(newVert.z);
+		floor_shifted.push_back(FLOOR[i+3]);
+		floor_shifted.push_back(FLOOR[i+4]); // texcoords
+	      }
+	  }
+}
+
+void meshTopology(const MazeTopologyCache& cache)
+{
+	// only wall faces next to an open cell and the tops, so the buffers are sized exactly up front
+	uint64_t cells = (uint64_t)cache.rows() * cache.cols();
+	cubes_shifted.reserve((cache.faceCount() + cache.wallCount()) * 30);
+	floor_shifted.reserve((cells - cache.wallCount()) * 30);
+	for (int row = 0; row < cache.rows(); row++)
+	{
+		for (int col = 0; col < cache.cols(); col++)
+		{
+			if (cache.isWall(row, col))
+				addWallFaces(row, col, ~cache.mask(row, col) & 15);
 			else
-			  {
-			    glm::vec3 shift = glm::vec3((float)row, 0.0f, -(float)col);
-			    glm::mat4 model = glm::mat4(1.0f);
-			    model = glm::translate(model, shift);
-			    for (int i = 0; i < 30; i += 5) // 30 is num vertices + tex for cube
-			      {
-				glm::vec4 newVert = glm::vec4(FLOOR[i], FLOOR[i+1], FLOOR[i+2], 1.0);
-				newVert = model*newVert;
-				floor_shifted.push_back(newVert.x);
-				floor_shifted.push_back(newVert.y);
-				floor_shifted.push_back(newVert.z);
-				floor_shifted.push_back(FLOOR[i+3]);
-				floor_shifted.push_back(FLOOR[i+4]); // texcoords
-			      }
-			  }
+				addCell(row, col, false);
 		}
 	}
+}
 
+void addWallFaces(int row, int col, unsigned openSides)
+{
+	// bit d of openSides set when the neighbour in direction d is open
+	for (int d = 0; d <= 4; d++)
+	{
+		if (d < 4 && !((openSides >> d) & 1))
+			continue;
+		const float* face = &CUBE_VERTICES[30 * (d < 4 ? CUBE_FACE[d] : CUBE_TOP)];
+		for (int i = 0; i < 30; i += 5)
+		{
+			cubes_shifted.push_back(face[i] + row);
+			cubes_shifted.push_back(face[i+1]);
+			cubes_shifted.push_back(face[i+2] - col);
+			cubes_shifted.push_back(face[i+3]);
+			cubes_shifted.push_back(face[i+4]); // texcoords
+		}
+	}
+}
+
+void uploadMesh(unsigned int VBO, unsigned int VBOFLOOR)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float)*cubes_shifted.size(), cubes_shifted.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, VBOFLOOR);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float)*floor_shifted.size(), floor_shifted.data(), GL_STATIC_DRAW);
 }
 
 bool inCorner()
 {
-  return ((int)camera.Position.x == MAZE_SIZE-2 && (int)camera.Position.z == -MAZE_SIZE+2);
+  int rows = pagedLevel ? paged.rows() : edgeLevel ? edges.rows() : m.data.rows();
+  int cols = pagedLevel ? paged.cols() : edgeLevel ? edges.cols() : m.data.cols();
+  return ((int)camera.Position.x == rows-2 && (int)camera.Position.z == -cols+2);
 }
 
 
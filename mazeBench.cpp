@@ -0,0 +1,702 @@
+// headless benchmark for the maze generators, prints cells carved per second
+// usage: ./mazeBench [size ...]   (sizes are odd grid widths, as passed to Maze)
+#include "Maze.h"
+#include "Eller.h"
+#include "LevelFile.h"
+#include "PagedGrid.h"
+#include "EdgeGrid.h"
+#include "TiledGrid.h"
+#include "WallSumTable.h"
+#include "MazeSolver.h"
+#include "CorridorGraph.h"
+#include "FlowField.h"
+#include "HierarchicalPathfinder.h"
+#include "DeadEndSolver.h"
+#include "DifficultyAnalyzer.h"
+#include "KeyDoorPuzzle.h"
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// fixed so every run generates the same mazes
+const uint64_t SEED = 1;
+
+// the recursive generator overflows the default call stack past this size
+const int RECURSIVE_LIMIT = 1001;
+
+// grid width the row-major and tiled layouts are compared at
+const int LAYOUT_SIZE = 8001;
+
+double cellsPerSecond(int size, generator gen, unsigned threads)
+{
+	auto start = std::chrono::steady_clock::now();
+	Maze m(size, gen, SEED, threads);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	double cells = (double)((size - 1) / 2) * ((size - 1) / 2);
+	return cells / elapsed.count();
+}
+
+void report(const char* name, int size, generator gen, unsigned threads = 0)
+{
+	double rate = cellsPerSecond(size, gen, threads);
+	double cells = (double)((size - 1) / 2) * ((size - 1) / 2);
+	std::cout << name << "\t" << size << "\t" << rate / 1e6 << " Mcells/s, " << cells / rate << " s" << std::endl;
+}
+
+void reportScaling(const char* name, int size, generator gen)
+{
+	// one thread against every hardware thread
+	double single = cellsPerSecond(size, gen, 1);
+	double all = cellsPerSecond(size, gen, 0);
+	std::cout << name << "\t" << size << "\t" << single / 1e6 << " Mcells/s on 1 thread, " << all / 1e6 << " Mcells/s on "
+		<< std::max(1u, std::thread::hardware_concurrency()) << " (x" << all / single << ")" << std::endl;
+}
+
+void reportStream(int size)
+{
+	// eller straight into a consumer that only looks at each row, 16 times as tall as wide
+	int width = (size - 1) / 2;
+	int rows = 16 * width;
+	uint64_t openBits = 0;
+	auto start = std::chrono::steady_clock::now();
+	EllerGenerator stream(width, SEED);
+	stream.generate(rows, [&](int, const uint64_t* words)
+	{
+		openBits += words[0] & 1;
+	});
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "ellerStream\t" << width << "x" << rows << "\t" << (double)width * rows / elapsed.count() / 1e6 << " Mcells/s" << std::endl;
+}
+
+void reportLevel(int size)
+{
+	// save, then load with and without checksum verification
+	const char* path = "mazeBench.glmz";
+	Maze m(size, binaryTree, SEED);
+	auto start = std::chrono::steady_clock::now();
+	m.save(path);
+	std::chrono::duration<double> saved = std::chrono::steady_clock::now() - start;
+	Maze mapped, verified;
+	start = std::chrono::steady_clock::now();
+	mapped.load(path, false);
+	std::chrono::duration<double> loaded = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+	verified.load(path, true);
+	std::chrono::duration<double> checked = std::chrono::steady_clock::now() - start;
+	std::remove(path);
+	std::cout << "level\t" << size << "\tsave " << saved.count() * 1e3 << " ms, load " << loaded.count() * 1e3
+		<< " ms, load+verify " << checked.count() * 1e3 << " ms" << std::endl;
+}
+
+void reportPaged(int size)
+{
+	// stream a maze 16 times as tall as wide to disk, then walk it through a small page budget
+	const char* path = "mazeBench.glmz";
+	int width = (size - 1) / 2;
+	int rows = 16 * width;
+	auto start = std::chrono::steady_clock::now();
+	EllerGenerator stream(width, SEED);
+	LevelWriter writer(path, 2 * rows + 1, stream.gridCols(), SEED, eller);
+	stream.generate(rows, [&](int, const uint64_t* words) { writer.writeRow(words); });
+	writer.finish();
+	std::chrono::duration<double> written = std::chrono::steady_clock::now() - start;
+	PagedGrid grid;
+	grid.open(path, 16 << 20);
+	start = std::chrono::steady_clock::now();
+	uint64_t open = 0;
+	for (int row = 0; row < grid.rows(); row++)
+	{
+		for (int col = 0; col < grid.cols(); col++)
+		{
+			open += grid.isOpen(row, col);
+		}
+	}
+	std::chrono::duration<double> scanned = std::chrono::steady_clock::now() - start;
+	std::remove(path);
+	double cells = (double)grid.rows() * grid.cols();
+	std::cout << "paged\t" << grid.cols() << "x" << grid.rows() << "\twrite " << written.count() << " s, scan "
+		<< cells / scanned.count() / 1e6 << " Mcells/s, " << grid.pageReads() << " page reads, " << grid.pagesHeld() << " pages held" << std::endl;
+}
+
+void reportEdges(int size)
+{
+	// round trip through the two bits per cell layout, at size and at the even size below
+	// whose spare wall row and column are dropped. everything off the converted grid is wall
+	for (int gridSize : {size, size - 1})
+	{
+		Maze m(gridSize, kruskal, SEED);
+		auto start = std::chrono::steady_clock::now();
+		EdgeGrid edges(m.data);
+		MazeGrid back = edges.toGrid();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		uint64_t differ = 0;
+		for (int row = 0; row < gridSize; row++)
+		{
+			for (int col = 0; col < gridSize; col++)
+			{
+				bool open = row < back.rows() && col < back.cols() && back.isOpen(row, col);
+				differ += open != m.data.isOpen(row, col);
+			}
+		}
+		std::cout << "edgeGrid\t" << gridSize << "\t" << edges.byteCount() << " bytes for " << m.data.wordCount() * sizeof(uint64_t)
+			<< ", round trip " << elapsed.count() * 1e3 << " ms, " << differ << " positions differ" << std::endl;
+	}
+}
+
+void reportWallSums(int size)
+{
+	// build the table, then count walls in random rectangles
+	Maze m(size, binaryTree, SEED);
+	auto start = std::chrono::steady_clock::now();
+	WallSumTable table(m.data);
+	std::chrono::duration<double> built = std::chrono::steady_clock::now() - start;
+	Rng rng(SEED);
+	int queries = 1 << 22;
+	int64_t walls = 0;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < queries; i++)
+	{
+		int row = rng.below(size), col = rng.below(size);
+		walls += table.wallCount(row, col, row + rng.below(size), col + rng.below(size));
+	}
+	std::chrono::duration<double> queried = std::chrono::steady_clock::now() - start;
+	std::cout << "wallSums\t" << size << "\tbuild " << built.count() * 1e3 << " ms, " << queries / queried.count() / 1e6
+		<< " Mqueries/s (" << walls << ")" << std::endl;
+}
+
+// plain queue BFS over the cells from the one at row, col, the reference the faster solvers
+// are checked against. cell steps indexed by cell row * cells per row + cell col
+std::vector<uint32_t> queueDistances(const MazeGrid& grid, int row, int col)
+{
+	int cellRows = cellsAlong(grid.rows()), cellCols = cellsAlong(grid.cols());
+	std::vector<uint32_t> dist((size_t)cellRows * cellCols, MazeSolver::UNREACHED);
+	if (dist.empty())
+	{
+		return dist;
+	}
+	std::vector<uint32_t> queue{(uint32_t)cellAt(row, cellRows) * cellCols + cellAt(col, cellCols)};
+	dist[queue[0]] = 0;
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		uint32_t cell = queue[head];
+		int r = cell / cellCols, c = cell % cellCols;
+		for (int d = 0; d < 4; d++)
+		{
+			int nr = r + DIRECTION_ROWS[d], nc = c + DIRECTION_COLS[d];
+			uint32_t next = (uint32_t)nr * cellCols + nc;
+			if (nr >= 0 && nc >= 0 && nr < cellRows && nc < cellCols && grid.isOpen(2 * r + 1 + DIRECTION_ROWS[d], 2 * c + 1 + DIRECTION_COLS[d]) &&
+				dist[next] == MazeSolver::UNREACHED)
+			{
+				dist[next] = dist[cell] + 1;
+				queue.push_back(next);
+			}
+		}
+	}
+	return dist;
+}
+
+double solveSeconds(const Maze& m, unsigned threads, uint32_t& longest)
+{
+	auto start = std::chrono::steady_clock::now();
+	MazeSolver solver(m.data, m.data.rows() - 2, m.data.cols() - 2, threads);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	longest = solver.maxDistance();
+	return elapsed.count();
+}
+
+void reportSolver(const char* name, int size, generator gen)
+{
+	// distance field to the goal corner, one thread against every hardware thread, then
+	// every cell against the queue BFS
+	Maze m(size, gen, SEED);
+	uint32_t longest = 0;
+	double single = solveSeconds(m, 1, longest);
+	double all = solveSeconds(m, 0, longest);
+	MazeSolver solver(m.data, size - 2, size - 2);
+	std::vector<uint32_t> expected = queueDistances(m.data, size - 2, size - 2);
+	uint64_t differ = 0;
+	for (size_t cell = 0; cell < expected.size(); cell++)
+	{
+		int row = 2 * (int)(cell / cellsAlong(size)) + 1, col = 2 * (int)(cell % cellsAlong(size)) + 1;
+		differ += solver.distance(row, col) != expected[cell];
+	}
+	std::cout << "solve " << name << "\t" << size << "\t" << single << " s on 1 thread, " << all << " s on "
+		<< std::max(1u, std::thread::hardware_concurrency()) << ", " << longest << " levels, "
+		<< (differ == 0 ? "same distances" : "DISTANCES DIFFER") << " (" << differ << " of " << expected.size() << " cells off)" << std::endl;
+}
+
+void reportCorridors(const char* name, int size, generator gen)
+{
+	// graph size against cells, then corner to corner and short random queries
+	Maze m(size, gen, SEED);
+	auto start = std::chrono::steady_clock::now();
+	CorridorGraph graph(m.data);
+	std::chrono::duration<double> built = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+	uint32_t across = graph.distance(1, 1, size - 2, size - 2);
+	std::chrono::duration<double> corner = std::chrono::steady_clock::now() - start;
+	Rng rng(SEED);
+	int queries = 1000, reach = std::min(50, size / 2);
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < queries; i++)
+	{
+		int row = rng.below(size), col = rng.below(size);
+		graph.distance(row, col, row + rng.below(2 * reach) - reach, col + rng.below(2 * reach) - reach);
+	}
+	std::chrono::duration<double> local = std::chrono::steady_clock::now() - start;
+	// distances and path lengths from random cells to a few goals against MazeSolver
+	const int GOALS = 4, STARTS = 250;
+	int differ = 0;
+	for (int goal = 0; goal < GOALS; goal++)
+	{
+		int goalRow = rng.below(size), goalCol = rng.below(size);
+		MazeSolver solver(m.data, goalRow, goalCol);
+		for (int i = 0; i < STARTS; i++)
+		{
+			int row = rng.below(size), col = rng.below(size);
+			uint32_t found = graph.distance(row, col, goalRow, goalCol);
+			size_t walked = graph.path(row, col, goalRow, goalCol).size();
+			differ += found != solver.distance(row, col) || (found != CorridorGraph::UNREACHED && walked != 2 * (size_t)found + 1);
+		}
+	}
+	double cells = (double)((size - 1) / 2) * ((size - 1) / 2);
+	std::cout << "corridors " << name << "\t" << size << "\t" << graph.nodeCount() << " nodes (" << cells / graph.nodeCount()
+		<< "x fewer than cells), build " << built.count() << " s, corner " << corner.count() * 1e3 << " ms (" << across
+		<< " steps), local " << local.count() / queries * 1e3 << " ms, " << (differ == 0 ? "same distances" : "DISTANCES DIFFER")
+		<< " (" << differ << " of " << GOALS * STARTS << " queries off)" << std::endl;
+}
+
+void reportFlow(int size)
+{
+	// agents all over the maze each look up one step per tick while the target wanders
+	const int AGENTS = 10000, TICKS = 1000;
+	Maze m(size, dfsIterative, SEED);
+	auto start = std::chrono::steady_clock::now();
+	FlowField field(m.data, size - 2, size - 2);
+	std::chrono::duration<double> built = std::chrono::steady_clock::now() - start;
+	Rng rng(SEED);
+	std::vector<std::pair<int, int>> agents(AGENTS);
+	for (std::pair<int, int>& agent : agents)
+	{
+		agent = {2 * (int)rng.below(cellsAlong(size)) + 1, 2 * (int)rng.below(cellsAlong(size)) + 1};
+	}
+	std::pair<int, int> target = field.target();
+	size_t rewritten = 0;
+	uint64_t moves = 0;
+	start = std::chrono::steady_clock::now();
+	for (int tick = 0; tick < TICKS; tick++)
+	{
+		int d = rng.below(4);
+		if (m.data.isOpen(target.first + DIRECTION_ROWS[d], target.second + DIRECTION_COLS[d]))
+		{
+			target = {target.first + 2 * DIRECTION_ROWS[d], target.second + 2 * DIRECTION_COLS[d]};
+			rewritten += field.retarget(target.first, target.second);
+		}
+		for (std::pair<int, int>& agent : agents)
+		{
+			direction towards;
+			if (field.towards(agent.first, agent.second, towards))
+			{
+				agent = {agent.first + 2 * DIRECTION_ROWS[towards], agent.second + 2 * DIRECTION_COLS[towards]};
+				moves++;
+			}
+		}
+	}
+	std::chrono::duration<double> ticked = std::chrono::steady_clock::now() - start;
+	// jumps to random targets against fields built from scratch for the same targets
+	const int CHECKS = 8;
+	uint64_t differ = 0;
+	for (int i = 0; i < CHECKS; i++)
+	{
+		int targetRow = rng.below(size), targetCol = rng.below(size);
+		field.retarget(targetRow, targetCol);
+		FlowField rebuilt(m.data, targetRow, targetCol);
+		for (int row = 1; row < 2 * cellsAlong(size); row += 2)
+		{
+			for (int col = 1; col < 2 * cellsAlong(size); col += 2)
+			{
+				direction kept = north, fresh = north;
+				bool moving = field.towards(row, col, kept);
+				differ += moving != rebuilt.towards(row, col, fresh) || (moving && kept != fresh);
+			}
+		}
+	}
+	std::cout << "flowField\t" << size << "\tbuild " << built.count() << " s, " << AGENTS << " agents " << ticked.count() / TICKS * 1e3
+		<< " ms per tick, " << (double)rewritten / TICKS << " cells rewritten per tick (" << moves << " moves), "
+		<< (differ == 0 ? "retarget matches rebuild" : "RETARGET DIFFERS") << " (" << differ << " cell directions off over " << CHECKS
+		<< " targets)" << std::endl;
+}
+
+void reportHierarchy(const char* name, int size, generator gen)
+{
+	// build on one thread and on all, random far queries, then rebuilding a cluster after a wall opens
+	Maze m(size, gen, SEED);
+	auto start = std::chrono::steady_clock::now();
+	HierarchicalPathfinder serial(m.data, 1);
+	std::chrono::duration<double> one = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+	HierarchicalPathfinder hierarchy(m.data);
+	std::chrono::duration<double> all = std::chrono::steady_clock::now() - start;
+	Rng rng(SEED);
+	int queries = 100;
+	uint64_t steps = 0;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < queries; i++)
+	{
+		uint32_t found = hierarchy.distance(rng.below(size), rng.below(size), rng.below(size), rng.below(size));
+		steps += found == HierarchicalPathfinder::UNREACHED ? 0 : found;
+	}
+	std::chrono::duration<double> far = std::chrono::steady_clock::now() - start;
+	int updates = 1000;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < updates; i++)
+	{
+		int row = 2 * rng.below(size / 2) + 1, col = 2 * rng.below(size / 2 - 1) + 2;
+		m.data.setOpen(row, col);
+		hierarchy.updateCluster((row - 1) / 2 / CLUSTER_CELLS, (col - 1) / 2 / CLUSTER_CELLS);
+	}
+	std::chrono::duration<double> updated = std::chrono::steady_clock::now() - start;
+	// open or close random passages either way round, repair, then random queries against a
+	// flat BFS of the edited grid
+	const int EDITS = 8, CHECKED = 25;
+	int cells = cellsAlong(size), differ = 0;
+	for (int edit = 0; edit < EDITS; edit++)
+	{
+		bool across = rng.below(2);
+		int row = across ? 2 * rng.below(cells) + 1 : 2 * rng.below(cells - 1) + 2;
+		int col = across ? 2 * rng.below(cells - 1) + 2 : 2 * rng.below(cells) + 1;
+		if (m.data.isOpen(row, col))
+		{
+			m.data.setWall(row, col);
+		}
+		else
+		{
+			m.data.setOpen(row, col);
+		}
+		hierarchy.updateCluster((row - 1) / 2 / CLUSTER_CELLS, (col - 1) / 2 / CLUSTER_CELLS);
+		int fromRow = rng.below(size), fromCol = rng.below(size);
+		std::vector<uint32_t> expected = queueDistances(m.data, fromRow, fromCol);
+		for (int i = 0; i < CHECKED; i++)
+		{
+			uint32_t cell = rng.below(expected.size());
+			differ += hierarchy.distance(fromRow, fromCol, 2 * (cell / cells) + 1, 2 * (cell % cells) + 1) != expected[cell];
+		}
+	}
+	std::cout << "hierarchy " << name << "\t" << size << "\t" << hierarchy.clusterCount() << " clusters, " << serial.entranceCount()
+		<< " entrances, build " << one.count() << " s on 1 thread, " << all.count() << " s on " << std::thread::hardware_concurrency()
+		<< ", far query " << far.count() / queries * 1e3 << " ms (" << steps / queries << " steps avg), cluster update "
+		<< updated.count() / updates * 1e6 << " us, " << (differ == 0 ? "repairs match bfs" : "REPAIRS DIFFER") << " (" << differ
+		<< " of " << EDITS * CHECKED << " queries off after " << EDITS << " edits)" << std::endl;
+}
+
+void reportDeadEnds(const char* name, int size, generator gen)
+{
+	// corner to corner on one thread and on all, against the BFS solver for the same path
+	Maze m(size, gen, SEED);
+	auto start = std::chrono::steady_clock::now();
+	DeadEndSolver serial(m.data, 1, 1, size - 2, size - 2, 1);
+	std::chrono::duration<double> one = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+	DeadEndSolver filled(m.data, 1, 1, size - 2, size - 2);
+	std::chrono::duration<double> all = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+	MazeSolver solver(m.data, size - 2, size - 2, 1);
+	size_t steps = solver.path(1, 1).size();
+	std::chrono::duration<double> bfs = std::chrono::steady_clock::now() - start;
+	std::cout << "deadEnds " << name << "\t" << size << "\t" << serial.sweepCount() << " sweeps, " << one.count() << " s on 1 thread, "
+		<< all.count() << " s on " << std::thread::hardware_concurrency() << ", bfs path " << bfs.count() << " s, "
+		<< (filled.openCount() == steps ? "same path" : "PATHS DIFFER") << " (" << (steps - 1) / 2 << " steps)" << std::endl;
+}
+
+void reportDifficulty(const char* name, int size, generator gen)
+{
+	// full analysis of one maze, then a search for a maze with a tenth longer solution,
+	// where most candidates are turned down after the first BFS
+	const int TRIES = 32;
+	Maze m(size, gen, SEED);
+	Difficulty difficulty;
+	auto start = std::chrono::steady_clock::now();
+	analyze(m.data, difficulty);
+	std::chrono::duration<double> analyzed = std::chrono::steady_clock::now() - start;
+	int longest = 0;
+	for (int i = 0; i < CORRIDOR_BUCKETS; i++)
+	{
+		longest = difficulty.corridors[i] > 0 ? i : longest;
+	}
+	DifficultyRange range;
+	range.minSolution = difficulty.solution + difficulty.solution / 10;
+	Maze found;
+	Difficulty harder;
+	start = std::chrono::steady_clock::now();
+	bool inRange = generateInRange(size, gen, SEED + 1, range, TRIES, found, harder);
+	std::chrono::duration<double> searched = std::chrono::steady_clock::now() - start;
+	std::cout << "difficulty " << name << "\t" << size << "\t" << difficulty.deadEnds << " dead ends, branching " << difficulty.branchingFactor()
+		<< ", solution " << difficulty.solution << ", diameter " << difficulty.diameter << ", corridors up to " << (2 << longest) - 1
+		<< " steps, analyze " << analyzed.count() << " s, ";
+	if (inRange)
+	{
+		std::cout << "seed " << found.getSeed() << " in range after " << searched.count() << " s" << std::endl;
+	}
+	else
+	{
+		std::cout << "none of " << TRIES << " in range, " << searched.count() << " s" << std::endl;
+	}
+}
+
+// plain BFS over (cell, keys held) states one at a time, the reference the bitset search
+// of KeyDoorPuzzle::solvable is checked against
+bool naiveSolvable(const MazeGrid& grid, const KeyDoorPuzzle& puzzle, int fromRow, int fromCol, int toRow, int toCol)
+{
+	int cellRows = cellsAlong(grid.rows()), cellCols = cellsAlong(grid.cols());
+	if (cellRows == 0 || cellCols == 0)
+	{
+		return false;
+	}
+	auto index = [&](int row, int col) { return (uint32_t)cellAt(row, cellRows) * cellCols + cellAt(col, cellCols); };
+	const std::vector<std::pair<int, int>>& keys = puzzle.getKeys();
+	std::vector<uint8_t> keyAt((size_t)cellRows * cellCols, 0);
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		keyAt[index(keys[i].first, keys[i].second)] |= 1 << i;
+	}
+	uint32_t masks = 1u << keys.size(), start = index(fromRow, fromCol), goal = index(toRow, toCol);
+	std::vector<bool> seen(keyAt.size() * masks, false);
+	std::vector<uint64_t> queue{(uint64_t)start * masks + keyAt[start]};
+	seen[queue[0]] = true;
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		uint32_t cell = queue[head] / masks, mask = queue[head] % masks;
+		if (cell == goal)
+		{
+			return true;
+		}
+		int r = cell / cellCols, c = cell % cellCols;
+		for (int d = 0; d < 4; d++)
+		{
+			int nr = r + DIRECTION_ROWS[d], nc = c + DIRECTION_COLS[d];
+			int passageRow = 2 * r + 1 + DIRECTION_ROWS[d], passageCol = 2 * c + 1 + DIRECTION_COLS[d];
+			if (nr < 0 || nc < 0 || nr >= cellRows || nc >= cellCols || !grid.isOpen(passageRow, passageCol))
+			{
+				continue;
+			}
+			int door = puzzle.doorAt(passageRow, passageCol);
+			if (door >= 0 && !((mask >> door) & 1))
+			{
+				continue;
+			}
+			uint32_t next = (uint32_t)nr * cellCols + nc;
+			uint64_t state = (uint64_t)next * masks + (mask | keyAt[next]);
+			if (!seen[state])
+			{
+				seen[state] = true;
+				queue.push_back(state);
+			}
+		}
+	}
+	return false;
+}
+
+void reportPuzzle(const char* name, int size, generator gen)
+{
+	// random key and door layouts validated until one is solvable, for a few key counts
+	const int LEVELS = 10, TRIES = 200;
+	Maze m(size, gen, SEED);
+	KeyDoorPuzzle puzzle(m.data, 1, 1, size - 2, size - 2);
+	std::cout << "keysDoors " << name << "\t" << size;
+	for (int keys : {1, 3, 6})
+	{
+		int placed = 0, layouts = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int level = 0; level < LEVELS; level++)
+		{
+			int tried = puzzle.placeRandom(keys, SEED + level, TRIES);
+			placed += tried > 0;
+			layouts += tried > 0 ? tried : TRIES;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << "\t" << keys << " keys: " << placed << "/" << LEVELS << " placed, " << layouts / elapsed.count() << " layouts/s";
+	}
+	// random layouts, solvable or not, against the naive search: doors on distinct passages
+	// of the keyless solution so they matter, keys anywhere
+	const int CHECKS = 20, CHECK_KEYS = 4;
+	std::vector<std::pair<int, int>> path = MazeSolver(m.data, size - 2, size - 2, 1).path(1, 1);
+	Rng rng(SEED);
+	int checked = 0, differ = 0, solvable = 0;
+	for (; checked < CHECKS && path.size() > 2 * CHECK_KEYS; checked++)
+	{
+		int keys = 1 + rng.below(CHECK_KEYS);
+		std::vector<std::pair<int, int>> keyCells(keys);
+		std::vector<KeyDoorPuzzle::Door> doors;
+		while ((int)doors.size() < keys)
+		{
+			std::pair<int, int> passage = path[2 * rng.below(path.size() / 2) + 1];
+			bool taken = false;
+			for (const KeyDoorPuzzle::Door& door : doors)
+			{
+				taken |= door.row == passage.first && door.col == passage.second;
+			}
+			if (!taken)
+			{
+				doors.push_back(KeyDoorPuzzle::Door{passage.first, passage.second, (int)doors.size()});
+			}
+		}
+		for (std::pair<int, int>& key : keyCells)
+		{
+			key = {2 * (int)rng.below(cellsAlong(size)) + 1, 2 * (int)rng.below(cellsAlong(size)) + 1};
+		}
+		puzzle.setLayout(keyCells, doors);
+		bool found = puzzle.solvable();
+		solvable += found;
+		differ += found != naiveSolvable(m.data, puzzle, 1, 1, size - 2, size - 2);
+	}
+	std::cout << ", " << (differ == 0 ? "same as naive bfs" : "SOLVABILITY DIFFERS") << " (" << differ << " of " << checked
+		<< " layouts off, " << solvable << " solvable)" << std::endl;
+}
+
+template <class Grid>
+double collisionSeconds(const Grid& grid, int queries, uint64_t& walls)
+{
+	// the 3x3 neighbourhood test of Camera::hitMaze at random positions
+	BoundedGrid<Grid> bounded{grid};
+	Rng rng(SEED);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < queries; i++)
+	{
+		int row = rng.below(grid.rows());
+		int col = rng.below(grid.cols());
+		for (int dRow = -1; dRow <= 1; dRow++)
+		{
+			for (int dCol = -1; dCol <= 1; dCol++)
+			{
+				walls += bounded.isWall(row + dRow, col + dCol);
+			}
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+template <class Grid>
+double bfsSeconds(const Grid& grid, uint64_t& reached)
+{
+	// flood fill from the start cell, visited marks kept in the same layout as the maze
+	Grid visited(grid.rows(), grid.cols());
+	std::vector<uint32_t> queue;
+	queue.reserve((size_t)grid.rows() * grid.cols() / 2);
+	auto start = std::chrono::steady_clock::now();
+	queue.push_back((uint32_t)grid.cols() + 1);
+	visited.setOpen(1, 1);
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int row = queue[head] / grid.cols();
+		int col = queue[head] % grid.cols();
+		for (int d = 0; d < 4; d++)
+		{
+			// the outer wall keeps every neighbour of an open cell inside the grid
+			int r = row + DIRECTION_ROWS[d], c = col + DIRECTION_COLS[d];
+			if (grid.isOpen(r, c) && visited.isWall(r, c))
+			{
+				visited.setOpen(r, c);
+				queue.push_back((uint32_t)r * grid.cols() + c);
+			}
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	reached += queue.size();
+	return elapsed.count();
+}
+
+template <class Grid>
+double meshSeconds(const Grid& grid, uint64_t& faces)
+{
+	// wall faces next to an open cell, in the order mazeInit visits cells
+	auto start = std::chrono::steady_clock::now();
+	for (int row = 1; row < grid.rows() - 1; row++)
+	{
+		for (int col = 1; col < grid.cols() - 1; col++)
+		{
+			if (grid.isWall(row, col))
+			{
+				faces += grid.isOpen(row - 1, col) + grid.isOpen(row + 1, col) + grid.isOpen(row, col - 1) + grid.isOpen(row, col + 1);
+			}
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+template <class Grid>
+void reportGrid(const char* name, const Grid& grid)
+{
+	uint64_t checksum = 0;
+	int queries = 1 << 24;
+	double collision = collisionSeconds(grid, queries, checksum);
+	double bfs = bfsSeconds(grid, checksum);
+	double mesh = meshSeconds(grid, checksum);
+	std::cout << name << "\t" << grid.cols() << "\tcollision " << queries / collision / 1e6 << " Mqueries/s, bfs " << bfs
+		<< " s, mesh " << mesh << " s (" << checksum << ")" << std::endl;
+}
+
+void reportLayout(int size)
+{
+	// the same maze row-major and in 8x8 tiles, the checksums must agree
+	Maze m(size, dfsIterative, SEED);
+	reportGrid("rowMajor", m.data);
+	auto start = std::chrono::steady_clock::now();
+	TiledGrid tiled(m.data);
+	std::chrono::duration<double> converted = std::chrono::steady_clock::now() - start;
+	reportGrid("tiled8x8", tiled);
+	std::cout << "tiled8x8\t" << size << "\tconversion " << converted.count() * 1e3 << " ms" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<int> sizes{101, 1001, 4001};
+	if (argc > 1)
+	{
+		sizes.clear();
+		for (int i = 1; i < argc; i++)
+		{
+			sizes.push_back(std::atoi(argv[i]) | 1);
+		}
+	}
+	for (int size : sizes)
+	{
+		if (size <= RECURSIVE_LIMIT)
+		{
+			report("dfsRecursive", size, dfsRecursive);
+		}
+		report("dfsIterative", size, dfsIterative);
+		report("kruskal", size, kruskal);
+		report("eller", size, eller);
+		reportStream(size);
+		reportScaling("tiled", size, tiled);
+		reportScaling("binaryTree", size, binaryTree);
+		reportScaling("sidewinder", size, sidewinder);
+		reportScaling("division", size, division);
+		report("wilson", size, wilson);
+		reportLevel(size);
+		reportPaged(size);
+		reportEdges(size);
+		reportWallSums(size);
+		reportSolver("dfsIterative", size, dfsIterative);
+		reportSolver("kruskal", size, kruskal);
+		reportCorridors("dfsIterative", size, dfsIterative);
+		reportCorridors("kruskal", size, kruskal);
+		reportFlow(size);
+		reportHierarchy("dfsIterative", size, dfsIterative);
+		reportHierarchy("kruskal", size, kruskal);
+		reportDeadEnds("dfsIterative", size, dfsIterative);
+		reportDeadEnds("kruskal", size, kruskal);
+		reportDifficulty("dfsIterative", size, dfsIterative);
+		reportDifficulty("kruskal", size, kruskal);
+		reportPuzzle("dfsIterative", size, dfsIterative);
+		reportPuzzle("kruskal", size, kruskal);
+	}
+	reportLayout(LAYOUT_SIZE);
+	return 0;
+}
@@ -0,0 +1,100 @@
+// headless batch maze generator, writes level files for the game to load
+// usage: ./glmaze-gen count size [first seed] [generator] [out dir] [threads] [min steps max steps]
+// with min and max steps only mazes whose solution is that long are kept, trying seeds in order
+#include "MazeBatch.h"
+#include "DifficultyAnalyzer.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// seeds tried for one level before giving up on the range
+const int RANGE_TRIES = 10000;
+
+void printUsage(const char* program)
+{
+	std::cout << "usage: " << program << " count size [first seed] [generator] [out dir] [threads] [min steps max steps]" << std::endl;
+	std::cout << "generators:";
+	for (uint32_t i = 0; i < GENERATOR_COUNT; i++)
+	{
+		std::cout << " " << generatorName(static_cast<generator>(i));
+	}
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+	int count = std::atoi(argv[1]);
+	int size = std::atoi(argv[2]);
+	if (count <= 0 || size < 3)
+	{
+		std::cout << "count must be at least 1 and size at least 3" << std::endl;
+		printUsage(argv[0]);
+		return 1;
+	}
+	if (argc == 8)
+	{
+		std::cout << "min steps given without max steps" << std::endl;
+		printUsage(argv[0]);
+		return 1;
+	}
+	size |= 1;
+	uint64_t firstSeed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0;
+	generator gen = dfsIterative;
+	if (argc > 4 && !generatorFromName(argv[4], gen))
+	{
+		std::cout << "Unknown generator " << argv[4] << std::endl;
+		return 1;
+	}
+	std::string outDir = argc > 5 ? argv[5] : "levels";
+	unsigned threads = argc > 6 ? std::atoi(argv[6]) : 0;
+
+	if (argc > 8)
+	{
+		DifficultyRange range;
+		range.minSolution = std::strtoul(argv[7], nullptr, 10);
+		range.maxSolution = std::strtoul(argv[8], nullptr, 10);
+		std::error_code ignored;
+		std::filesystem::create_directories(outDir, ignored);
+		auto start = std::chrono::steady_clock::now();
+		uint64_t seed = firstSeed;
+		int written = 0;
+		for (; written < count; written++)
+		{
+			Maze found;
+			Difficulty difficulty;
+			if (!generateInRange(size, gen, seed, range, RANGE_TRIES, found, difficulty, threads))
+			{
+				std::cout << "No maze in range among seeds " << seed << " to " << seed + RANGE_TRIES - 1 << std::endl;
+				break;
+			}
+			if (!found.save(batchPath(outDir, found.getSeed())))
+			{
+				std::cout << "Failed to save maze " << found.getSeed() << std::endl;
+				break;
+			}
+			seed = found.getSeed() + 1;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << written << " mazes of " << size << "x" << size << " (" << generatorName(gen) << ") with " << range.minSolution << " to "
+			<< range.maxSolution << " steps written to " << outDir << " in " << elapsed.count() << " s, " << seed - firstSeed
+			<< " seeds tried" << std::endl;
+		return written == count ? 0 : 1;
+	}
+
+	BatchStats stats = generateBatch(count, firstSeed, size, gen, outDir, threads);
+	std::cout << stats.written << " mazes of " << size << "x" << size << " (" << generatorName(gen) << ") written to " << outDir
+		<< " in " << stats.seconds << " s, " << stats.written / stats.seconds << " mazes/s" << std::endl;
+	if (stats.failed > 0)
+	{
+		std::cout << stats.failed << " mazes failed to save" << std::endl;
+		return 1;
+	}
+	return 0;
+}